@@ -65,6 +65,451 @@ static CImg<T> rounded_copy(const CImg<T>& img) {
   return CImg<T>(img,true);
 }
 
+// Same as 'rounded_copy(img).save_raw(filename)', but convert values by cache-sized blocks,
+// so that no full-size copy of the image is allocated.
+template<typename t>
+static void save_rounded_raw(const CImg<t>& img, const char *const filename) {
+  if (!filename)
+    throw CImgArgumentException("CImg<%s>::save_rounded_raw(): Specified filename is (null).",
+                                pixel_type());
+  std::FILE *const nfile = cimg::fopen(filename,"wb");
+  const ulongT siz = img.size();
+  CImg<T> buf((unsigned int)std::min(siz,(ulongT)(1<<18)/sizeof(T)));
+  const bool is_rounded = cimg::type<t>::is_float() && !cimg::type<T>::is_float();
+  for (ulongT off = 0; off<siz; off+=buf._width) {
+    const int N = (int)std::min((ulongT)buf._width,siz - off);
+    const t *const ptrs = img._data + off;
+    T *const ptrd = buf._data;
+    if (is_rounded) {
+      cimg_pragma_openmp(parallel for cimg_openmp_if_size(N,16384))
+      for (int i = 0; i<N; ++i) ptrd[i] = (T)cimg::round(ptrs[i]);
+    } else {
+      cimg_pragma_openmp(parallel for cimg_openmp_if_size(N,16384))
+      for (int i = 0; i<N; ++i) ptrd[i] = (T)ptrs[i];
+    }
+    cimg::fwrite(ptrd,(size_t)N,nfile);
+  }
+  cimg::fclose(nfile);
+}
+
+static void save_rounded_raw(const CImg<T>& img, const char *const filename) {
+  img.save_raw(filename);
+}
+
+// Same as 'CImg<t>::get_load_raw(filename,...)', but values are converted directly from a read-only
+// memory map of the file, so that no intermediate buffer with pixel type 't' is allocated
+// (Linux only, when image dimensions are specified).
+template<typename t>
+static CImg<T> get_load_raw_mapped(const char *const filename,
+                                   const unsigned int size_x, const unsigned int size_y,
+                                   const unsigned int size_z, const unsigned int size_c,
+                                   const ulongT offset) {
+#if defined(__linux__)
+  const ulongT siz = (ulongT)size_x*size_y*size_z*size_c, len = offset + siz*sizeof(t);
+  if (siz && std::strcmp(cimg::type<t>::string(),cimg::type<T>::string()) && !(offset%sizeof(t)) &&
+      filename && *filename && std::strcmp(filename,"-")) {
+    const int fd = open(filename,O_RDONLY);
+    if (fd>=0) {
+      struct stat st;
+      void *const map = !fstat(fd,&st) && S_ISREG(st.st_mode) && (ulongT)st.st_size>=len?
+        mmap(0,(size_t)len,PROT_READ,MAP_PRIVATE,fd,0):MAP_FAILED;
+      close(fd);
+      if (map!=MAP_FAILED) {
+        madvise(map,(size_t)len,MADV_WILLNEED);
+        CImg<T> res(size_x,size_y,size_z,size_c);
+        const t *const ptrs = (const t*)((const char*)map + offset);
+        T *const ptrd = res._data;
+        cimg_pragma_openmp(parallel for cimg_openmp_if_size(siz,65536))
+        for (longT off = 0; off<(longT)siz; ++off) ptrd[off] = (T)ptrs[off];
+        munmap(map,(size_t)len);
+        return res;
+      }
+    }
+  }
+#endif // #if defined(__linux__)
+  return CImg<t>::get_load_raw(filename,size_x,size_y,size_z,size_c,false,false,offset);
+}
+
+// Parse a decimal floating-point value from string 'ptr' (not necessarily null-terminated, ends at 'ptr_end').
+// Values with at most 15 significant digits and a small exponent are converted exactly without
+// calling 'std::strtod()' (which handles all other cases). Set '*end' to 'ptr' if no value can be read.
+static double gmic_strtod(const char *const ptr, const char *const ptr_end, const char **const end) {
+  static const double pow10[] = {
+    1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,
+    1e16,1e17,1e18,1e19,1e20,1e21,1e22
+  };
+  const char *p = ptr;
+  const bool is_neg = p<ptr_end && *p=='-';
+  if (p<ptr_end && (*p=='-' || *p=='+')) ++p;
+  cimg_uint64 mant = 0;
+  int nb_digits = 0, nb_significant = 0, exp10 = 0;
+  for ( ; p<ptr_end && *p>='0' && *p<='9'; ++p, ++nb_digits)
+    if (mant || *p!='0') { if (++nb_significant<=15) mant = 10*mant + (*p - '0'); }
+  if (p<ptr_end && *p=='.')
+    for (++p; p<ptr_end && *p>='0' && *p<='9'; ++p, ++nb_digits)
+      if (mant || *p!='0') { if (++nb_significant<=15) { mant = 10*mant + (*p - '0'); --exp10; } }
+      else --exp10;
+  if (p<ptr_end && (*p=='e' || *p=='E')) {
+    const char *q = p + 1;
+    const bool is_eneg = q<ptr_end && *q=='-';
+    if (q<ptr_end && (*q=='-' || *q=='+')) ++q;
+    if (q<ptr_end && *q>='0' && *q<='9') {
+      int e = 0;
+      for ( ; q<ptr_end && *q>='0' && *q<='9'; ++q) if (e<100000) e = 10*e + (*q - '0');
+      exp10+=is_eneg?-e:e;
+      p = q;
+    }
+  }
+  if (!nb_digits || nb_significant>15 || exp10<-22 || exp10>22) { // Slow path
+    char str[64];
+    const unsigned int l = (unsigned int)std::min((cimg_long)63,(cimg_long)(ptr_end - ptr));
+    std::memcpy(str,ptr,l);
+    str[l] = 0;
+    char *_end = 0;
+    const double val = std::strtod(str,&_end);
+    *end = ptr + (_end - str);
+    return val;
+  }
+  const double val = exp10<0?(double)mant/pow10[-exp10]:(double)mant*pow10[exp10];
+  *end = p;
+  return is_neg?-val:val;
+}
+
+// Write the shortest decimal representation of 'val' that reads back as the same value of type 'T'
+// into 'str' (which must have at least 32 chars). Return the number of written chars.
+static unsigned int gmic_format_value(const T val, char *const str) {
+  if (!cimg::type<T>::is_float())
+    return (unsigned int)cimg_snprintf(str,32,cimg::type<T>::format(),cimg::type<T>::format(val));
+  const double dval = (double)val;
+  if (cimg::type<double>::is_nan(dval) || cimg::type<double>::is_inf(dval))
+    return (unsigned int)cimg_snprintf(str,32,"%g",dval);
+  if (dval>-1e15 && dval<1e15 && dval==(double)(cimg_int64)dval && (dval || 1/dval>0)) {
+    // Integer value.
+    char digits[24], *ptr = digits;
+    cimg_uint64 uval = (cimg_uint64)(dval<0?-dval:dval);
+    do { *(ptr++) = (char)('0' + uval%10); uval/=10; } while (uval);
+    char *ptrd = str;
+    if (dval<0) *(ptrd++) = '-';
+    while (ptr>digits) *(ptrd++) = *(--ptr);
+    *ptrd = 0;
+    return (unsigned int)(ptrd - str);
+  }
+  const int
+    p0 = sizeof(T)<=sizeof(float)?6:15,
+    p1 = sizeof(T)<=sizeof(float)?9:17;
+  int n = 0;
+  for (int p = p0; p<=p1; ++p) { // Precisions below 'p0' cannot be shorter (trailing zeros are removed)
+    n = cimg_snprintf(str,32,"%.*g",p,dval);
+    const char *end = 0;
+    if (p==p1 || (T)gmic_strtod(str,str + n,&end)==val) break;
+  }
+  return (unsigned int)n;
+}
+
+// Same as 'load_dlm(filename)', but parse values from a memory map of the file (Linux) or from a single
+// read buffer, with chunks of rows parsed in parallel.
+CImg<T>& load_gmic_dlm(const char *const filename) {
+  if (!filename)
+    throw CImgArgumentException(_cimg_instance
+                                "load_gmic_dlm(): Specified filename is (null).",
+                                cimg_instance);
+  const char *buf = 0;
+  char *_buf = 0;  // Read buffer (when the file is not mapped), may exceed 4 GB
+  cimg_ulong siz = 0;
+#if defined(__linux__)
+  void *map = MAP_FAILED;
+  const int fd = open(filename,O_RDONLY);
+  if (fd>=0) {
+    struct stat st;
+    if (!fstat(fd,&st) && S_ISREG(st.st_mode) && st.st_size>0) {
+      siz = (cimg_ulong)st.st_size;
+      map = mmap(0,(size_t)siz,PROT_READ,MAP_PRIVATE,fd,0);
+      if (map!=MAP_FAILED) {
+        madvise(map,(size_t)siz,MADV_WILLNEED);
+        buf = (const char*)map;
+      }
+    }
+    close(fd);
+  }
+#endif // #if defined(__linux__)
+  if (!buf) {
+    std::FILE *const file = cimg::fopen(filename,"rb");
+    cimg::fseek(file,0,SEEK_END);
+    const cimg_long fsiz = cimg::ftell(file);
+    cimg::fseek(file,0,SEEK_SET);
+    if (fsiz>0) {
+      try { _buf = new char[(size_t)fsiz]; } catch (...) { cimg::fclose(file); throw; }
+      siz = (cimg_ulong)cimg::fread(_buf,(size_t)fsiz,file);
+    }
+    cimg::fclose(file);
+    buf = _buf;
+  }
+
+  // Split file into chunks that start at the beginning of a line.
+  const cimg_ulong csiz = (cimg_ulong)1<<20;
+  CImg<cimg_ulong> offsets((unsigned int)(siz/csiz + 1));
+  unsigned int nb_chunks = 0;
+  offsets[nb_chunks++] = 0;
+  for (cimg_ulong off = csiz; off<siz; ) {
+    const char *const ptr = (const char*)std::memchr(buf + off,'\n',(size_t)(siz - off));
+    if (!ptr) break;
+    const cimg_ulong noff = (cimg_ulong)(ptr - buf) + 1;
+    if (noff<siz) offsets[nb_chunks++] = noff;
+    off = noff + csiz;
+  }
+  CImgList<T> values(nb_chunks);
+  CImgList<unsigned int> widths(nb_chunks);
+  CImg<unsigned int> nb_values(nb_chunks,1,1,1,0), nb_rows(nb_chunks,1,1,1,0);
+  CImg<unsigned char> is_stopped(nb_chunks,1,1,1,0);
+  cimg_pragma_openmp(parallel for schedule(dynamic,1) if (nb_chunks>1))
+  for (int k = 0; k<(int)nb_chunks; ++k) {
+    const char
+      *ptr = buf + offsets[k],
+      *const ptr_end = buf + (k==(int)nb_chunks - 1?siz:offsets[k + 1]);
+    CImg<T> &vals = values[k];
+    CImg<unsigned int> &wids = widths[k];
+    vals.assign((unsigned int)std::max((cimg_long)16,(cimg_long)(ptr_end - ptr)/8));
+    wids.assign(256);
+    unsigned int &nv = nb_values[k], &nr = nb_rows[k], cdx = 0;
+    bool is_value_at_end = false;
+    // As with 'load_dlm()', the file must start with a value (leading spaces apart), so that a header
+    // line is rejected. Other chunks start after a newline, in the delimiter that follows a value.
+    if (k) while (ptr<ptr_end && !_gmic_is_dlm_value_char(*ptr)) ++ptr;
+    else while (ptr<ptr_end && (unsigned char)*ptr<=' ') ++ptr;
+    while (ptr<ptr_end) {
+      const char *ptr_next = 0;
+      const double val = gmic_strtod(ptr,ptr_end,&ptr_next);
+      if (ptr_next==ptr) { is_stopped[k] = 1; break; }
+      is_value_at_end = ptr_next==ptr_end;
+      if (nv>=vals._width) vals.resize(2*vals._width,1,1,1,0);
+      vals[nv++] = (T)val;
+      ++cdx;
+      bool is_newline = false;
+      for (ptr = ptr_next; ptr<ptr_end && !_gmic_is_dlm_value_char(*ptr); ++ptr) if (*ptr=='\n') is_newline = true;
+      if (is_newline) {
+        if (nr>=wids._width) wids.resize(2*wids._width,1,1,1,0);
+        wids[nr++] = cdx;
+        cdx = 0;
+      }
+    }
+    // As with 'load_dlm()', an unterminated last row is kept only if the file ends right after its last value
+    // (not after a delimiter, nor before a value that cannot be read).
+    if (cdx && is_value_at_end && !is_stopped[k]) {
+      if (nr>=wids._width) wids.resize(2*wids._width,1,1,1,0);
+      wids[nr++] = cdx;
+    }
+  }
+#if defined(__linux__)
+  if (map!=MAP_FAILED) munmap(map,(size_t)siz);
+#endif // #if defined(__linux__)
+  delete[] _buf;
+
+  // Merge chunks, up to the first value that cannot be read.
+  unsigned int nb_kept = 0, dx = 0, dy = 0;
+  CImg<unsigned int> row_offsets(nb_chunks,1,1,1,0);
+  while (nb_kept<nb_chunks) {
+    row_offsets[nb_kept] = dy;
+    dy+=nb_rows[nb_kept];
+    cimg_forX(widths[nb_kept],r) if (r<(int)nb_rows[nb_kept]) dx = std::max(dx,widths[nb_kept][r]);
+    if (is_stopped[nb_kept++]) break;
+  }
+  if (!dx || !dy)
+    throw CImgIOException(_cimg_instance
+                          "load_gmic_dlm(): Invalid DLM file '%s'.",
+                          cimg_instance,filename);
+  assign(dx,dy);
+  cimg_pragma_openmp(parallel for schedule(dynamic,1) if (nb_kept>1))
+  for (int k = 0; k<(int)nb_kept; ++k) {
+    const T *ptrs = values[k]._data;
+    for (unsigned int r = 0; r<nb_rows[k]; ++r) {
+      const unsigned int w = widths[k][r];
+      T *const ptrd = data(0,row_offsets[k] + r);
+      std::memcpy(ptrd,ptrs,w*sizeof(T));
+      if (w<dx) std::memset(ptrd + w,0,(dx - w)*sizeof(T));
+      ptrs+=w;
+    }
+    values[k].assign();
+  }
+  return *this;
+}
+
+static bool _gmic_is_dlm_value_char(const char c) { // Chars that can be part of a value in a DLM file
+  return (c>='0' && c<='9') || c=='e' || c=='E' || c=='i' || c=='n' || c=='f' || c=='a' ||
+    c=='.' || c=='+' || c=='-';
+}
+
+// Same as 'save_dlm(filename)', but values are formatted by blocks in parallel,
+// with the shortest representation that reads back the same value.
+const CImg<T>& save_gmic_dlm(const char *const filename) const {
+  if (!filename)
+    throw CImgArgumentException(_cimg_instance
+                                "save_gmic_dlm(): Specified filename is (null).",
+                                cimg_instance);
+  if (is_empty()) { cimg::fempty(0,filename); return *this; }
+  if (_depth>1)
+    cimg::warn(_cimg_instance
+               "save_gmic_dlm(): Instance is volumetric, values along Z will be unrolled in file '%s'.",
+               cimg_instance,filename);
+  if (_spectrum>1)
+    cimg::warn(_cimg_instance
+               "save_gmic_dlm(): Instance is multispectral, values along C will be unrolled in file '%s'.",
+               cimg_instance,filename);
+
+  std::FILE *const nfile = cimg::fopen(filename,"w");
+  const cimg_ulong
+    siz = size(),
+    block_siz = (cimg_ulong)1<<17, // At most 32 characters per formatted value, i.e. 4 MB per block
+    nb_blocks = (siz + block_siz - 1)/block_siz;
+  const unsigned int nb_threads = (unsigned int)std::min((cimg_ulong)cimg::nb_cpus(),nb_blocks);
+  CImgList<char> bufs(nb_threads,(unsigned int)(std::min(block_siz,siz)*32 + 32));
+  CImg<cimg_ulong> lens(nb_threads);
+  for (cimg_ulong b0 = 0; b0<nb_blocks; b0+=nb_threads) { // Format 'nb_threads' blocks, then write them
+    const unsigned int nb = (unsigned int)std::min((cimg_ulong)nb_threads,nb_blocks - b0);
+    cimg_pragma_openmp(parallel for num_threads(nb) if (nb>1))
+    for (int b = 0; b<(int)nb; ++b) {
+      const cimg_ulong
+        off0 = (b0 + b)*block_siz,
+        off1 = std::min(siz,off0 + block_siz);
+      char *ptrd = bufs[b]._data;
+      unsigned int x = (unsigned int)(off0%_width);
+      for (cimg_ulong off = off0; off<off1; ++off) {
+        ptrd+=gmic_format_value(_data[off],ptrd);
+        if (++x==_width) { x = 0; *(ptrd++) = '\n'; } else *(ptrd++) = ',';
+      }
+      lens[b] = (cimg_ulong)(ptrd - bufs[b]._data);
+    }
+    for (unsigned int b = 0; b<nb; ++b) cimg::fwrite(bufs[b]._data,(size_t)lens[b],nfile);
+  }
+  cimg::fclose(nfile);
+  return *this;
+}
+
+// Same as 'save_cpp(filename)', but values are formatted by blocks in parallel,
+// with the shortest representation that reads back the same value.
+const CImg<T>& save_gmic_cpp(const char *const filename) const {
+  if (!filename)
+    throw CImgArgumentException(_cimg_instance
+                                "save_gmic_cpp(): Specified filename is (null).",
+                                cimg_instance);
+  std::FILE *const file = cimg::fopen(filename,"w");
+  CImg<char> varname(1024); *varname = 0;
+  if (cimg_sscanf(cimg::basename(filename),"%1023[a-zA-Z0-9_]",varname._data)!=1)
+    std::strcpy(varname,"unnamed");
+  std::fprintf(file,
+               "/* Define image '%s' of size %ux%ux%ux%u and type '%s' */\n"
+               "%s data_%s[] = { %s\n  ",
+               varname._data,_width,_height,_depth,_spectrum,pixel_type(),pixel_type(),varname._data,
+               is_empty()?"};":"");
+  if (!is_empty()) {
+    const cimg_ulong
+      siz = size(),
+      block_siz = (cimg_ulong)1<<16,
+      nb_blocks = (siz + block_siz - 1)/block_siz;
+    const unsigned int nb_threads = (unsigned int)std::min((cimg_ulong)cimg::nb_cpus(),nb_blocks);
+    CImgList<char> bufs(nb_threads,(unsigned int)(std::min(block_siz,siz)*36 + 32));
+    CImg<cimg_ulong> lens(nb_threads);
+    for (cimg_ulong b0 = 0; b0<nb_blocks; b0+=nb_threads) { // Format 'nb_threads' blocks, then write them
+      const unsigned int nb = (unsigned int)std::min((cimg_ulong)nb_threads,nb_blocks - b0);
+      cimg_pragma_openmp(parallel for num_threads(nb) if (nb>1))
+      for (int b = 0; b<(int)nb; ++b) {
+        const cimg_ulong
+          off0 = (b0 + b)*block_siz,
+          off1 = std::min(siz,off0 + block_siz);
+        char *ptrd = bufs[b]._data;
+        for (cimg_ulong off = off0; off<off1; ++off) {
+          ptrd+=gmic_format_value(_data[off],ptrd);
+          if (off==siz - 1) { std::memcpy(ptrd," };\n",4); ptrd+=4; }
+          else if (!((off + 1)%16)) { std::memcpy(ptrd,",\n  ",4); ptrd+=4; }
+          else { *(ptrd++) = ','; *(ptrd++) = ' '; }
+        }
+        lens[b] = (cimg_ulong)(ptrd - bufs[b]._data);
+      }
+      for (unsigned int b = 0; b<nb; ++b) cimg::fwrite(bufs[b]._data,(size_t)lens[b],file);
+    }
+  }
+  cimg::fclose(file);
+  return *this;
+}
+
+#ifdef cimg_use_fftw3
+// Compute the direct (or inverse) FFT of a real-valued image along all axes, as a real-to-complex transform
+// (half the work and memory of a complex transform), and return it as the usual pair of real and imaginary
+// images. Return 'false' if no FFTW plan is available for the image size.
+static bool gmic_fft_real(const CImg<T>& img, CImg<T>& real, CImg<T>& imag, const bool is_inverse) {
+  const int w = img.width(), h = img.height(), d = img.depth(), hw = w/2 + 1;
+  const ulongT N = (ulongT)w*h*d, hN = (ulongT)hw*h*d;
+  const fftw_plan plan = _gmic_fftw_plan(w,h,d);
+  if (!plan) return false;
+  real.assign(img._width,img._height,img._depth,img._spectrum);
+  imag.assign(img._width,img._height,img._depth,img._spectrum);
+  const double sgn = is_inverse?-1:1, scale = is_inverse?1./N:1.; // Inverse of real data: 'conj(FFT)/N'
+  cimg_pragma_openmp(parallel for cimg_openmp_if(img._spectrum>1 && N>=4096))
+  cimg_forC(img,c) {
+    double *const in = (double*)fftw_malloc(sizeof(double)*N);
+    fftw_complex *const out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*hN);
+    const T *const ptrs = img.data(0,0,0,c);
+    for (ulongT k = 0; k<N; ++k) in[k] = (double)ptrs[k];
+    fftw_execute_dft_r2c(plan,in,out);
+    T *const ptrr = real.data(0,0,0,c), *const ptri = imag.data(0,0,0,c);
+    cimg_forXYZ(img,x,y,z) {
+      const ulongT off = ((ulongT)z*h + y)*w + x;
+      if (x<hw) {
+        const double *const v = out[((ulongT)z*h + y)*hw + x];
+        ptrr[off] = (T)(v[0]*scale);
+        ptri[off] = (T)(sgn*v[1]*scale);
+      } else { // Hermitian symmetry: 'F(x,y,z) = conj(F(-x,-y,-z))'
+        const double *const v = out[((ulongT)(z?d - z:0)*h + (y?h - y:0))*hw + w - x];
+        ptrr[off] = (T)(v[0]*scale);
+        ptri[off] = (T)(-sgn*v[1]*scale);
+      }
+    }
+    fftw_free(in);
+    fftw_free(out);
+  }
+  return true;
+}
+
+// Return a real-to-complex FFTW plan (or complex-to-real if 'is_c2r==true') for images of size 'w x h x d'.
+// Plans are created once and kept for the process lifetime, so that repeated transforms of same-sized images
+// skip planning. A size is first planned with 'FFTW_ESTIMATE' (no planning cost), and planned again with
+// 'FFTW_MEASURE' (faster transforms, but slow planning) only when it is requested a second time, i.e. when
+// the planning cost is likely to be paid back by later transforms.
+// Plans can be executed concurrently with 'fftw_execute_dft_r2c()' and 'fftw_execute_dft_c2r()', on arrays
+// allocated with 'fftw_malloc()'.
+static fftw_plan _gmic_fftw_plan(const int w, const int h, const int d, const bool is_c2r=false) {
+  static int sizes[4*64];
+  static fftw_plan plans[64], estimated_plans[64];
+  static unsigned int nb_plans = 0;
+  const ulongT N = (ulongT)w*h*d;
+  const unsigned int flags = N<=((ulongT)1<<22)?FFTW_MEASURE:FFTW_ESTIMATE; // Flags for a reused size
+  fftw_plan plan = 0;
+  cimg::mutex(12); // Same mutex as CImg's own FFTW calls, as the FFTW planner is not thread-safe
+  int ind = -1;
+  for (unsigned int k = 0; k<nb_plans && ind<0; ++k)
+    if (sizes[4*k]==w && sizes[4*k + 1]==h && sizes[4*k + 2]==d && sizes[4*k + 3]==(int)is_c2r) ind = (int)k;
+  if (ind>=0) plan = plans[ind];
+  if ((ind<0 && nb_plans<64) || (ind>=0 && flags!=FFTW_ESTIMATE && plan==estimated_plans[ind])) {
+    double *const in = (double*)fftw_malloc(sizeof(double)*N);
+    fftw_complex *const out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*(w/2 + 1)*h*d);
+    const unsigned int nflags = ind<0?FFTW_ESTIMATE:flags;
+    const fftw_plan nplan = is_c2r?fftw_plan_dft_c2r_3d(d,h,w,out,in,nflags):fftw_plan_dft_r2c_3d(d,h,w,in,out,nflags);
+    fftw_free(in);
+    fftw_free(out);
+    if (ind<0) {
+      if (nplan) {
+        sizes[4*nb_plans] = w; sizes[4*nb_plans + 1] = h; sizes[4*nb_plans + 2] = d;
+        sizes[4*nb_plans + 3] = (int)is_c2r;
+        plans[nb_plans] = estimated_plans[nb_plans] = plan = nplan;
+        ++nb_plans;
+      }
+    } else if (nplan) plans[ind] = plan = nplan; // Estimated plan is kept, as it may be in use by other threads
+    else estimated_plans[ind] = 0; // Do not try measuring again
+  }
+  cimg::mutex(12,0);
+  return plan;
+}
+#endif // #ifdef cimg_use_fftw3
+
 static const char *storage_type(const CImgList<T>& images) {
   T im = cimg::type<T>::max(), iM = cimg::type<T>::min();
   bool is_int = true;
@@ -119,9 +564,9 @@ static CImg<T> append_CImg3d(const CImgList<T>& images) {
   cimglist_for(images,l) { // Merge object points
     const CImg<T>& img = images[l];
     const unsigned int nbv = cimg::float2uint((float)img[6]);
-    std::memcpy(ptrd,img._data + 8,3*nbv*sizeof(T));
-    ptrd+=3*nbv;
-    ptrs[l] = img._data + 8 + 3*nbv;
+    std::memcpy(ptrd,img._data + 8,3*(ulongT)nbv*sizeof(T));
+    ptrd+=3*(ulongT)nbv;
+    ptrs[l] = img._data + 8 + 3*(ulongT)nbv;
   }
   ulongT poff = 0;
   cimglist_for(images,l) { // Merge object primitives
@@ -217,7 +662,7 @@ CImg<T>& color_CImg3d(const float R, const float G, const float B, const float o
   const unsigned int
     nbv = cimg::float2uint((float)*(ptrd++)),
     nbp = cimg::float2uint((float)*(ptrd++));
-  ptrd+=3*nbv;
+  ptrd+=3*(ulongT)nbv;
   for (unsigned int i = 0; i<nbp; ++i) { const unsigned int N = (unsigned int)*(ptrd++); ptrd+=N; }
   for (unsigned int c = 0; c<nbp; ++c)
     if (*ptrd==(T)-128) {
@@ -226,7 +671,7 @@ CImg<T>& color_CImg3d(const float R, const float G, const float B, const float o
         w = (unsigned int)*(ptrd++),
         h = (unsigned int)*(ptrd++),
         s = (unsigned int)*(ptrd++);
-      ptrd+=w*h*s;
+      ptrd+=(ulongT)w*h*s;
     } else if (set_RGB) { *(ptrd++) = (T)R; *(ptrd++) = (T)G; *(ptrd++) = (T)B; } else ptrd+=3;
   if (set_opacity)
     for (unsigned int o = 0; o<nbp; ++o) {
@@ -236,7 +681,7 @@ CImg<T>& color_CImg3d(const float R, const float G, const float B, const float o
           w = (unsigned int)*(ptrd++),
           h = (unsigned int)*(ptrd++),
           s = (unsigned int)*(ptrd++);
-        ptrd+=w*h*s;
+        ptrd+=(ulongT)w*h*s;
       } else *(ptrd++) = (T)opacity;
     }
   return *this;
@@ -370,17 +815,17 @@ CImg<T> get_gmic_autocrop(const CImg<T>& color=CImg<T>::empty()) {
 CImg<T>& gmic_blur(const float sigma_x, const float sigma_y, const float sigma_z, const float sigma_c,
                    const bool boundary_conditions, const bool is_gaussian) {
   if (is_empty()) return *this;
-  if (is_gaussian) {
-    if (_width>1) vanvliet(sigma_x,0,'x',boundary_conditions);
-    if (_height>1) vanvliet(sigma_y,0,'y',boundary_conditions);
-    if (_depth>1) vanvliet(sigma_z,0,'z',boundary_conditions);
-    if (_spectrum>1) vanvliet(sigma_c,0,'c',boundary_conditions);
-  } else {
-    if (_width>1) deriche(sigma_x,0,'x',boundary_conditions);
-    if (_height>1) deriche(sigma_y,0,'y',boundary_conditions);
-    if (_depth>1) deriche(sigma_z,0,'z',boundary_conditions);
-    if (_spectrum>1) deriche(sigma_c,0,'c',boundary_conditions);
+  if (!cimg::type<T>::is_float()) // Convert to float once, rather than for each axis
+    // (so, unlike the per-axis CImg filters, values are not rounded between two axes).
+    return CImg<Tfloat>(*this,false).gmic_blur(sigma_x,sigma_y,sigma_z,sigma_c,boundary_conditions,is_gaussian).
+      move_to(*this);
+  if (_width>1) {
+    if (is_gaussian) vanvliet(sigma_x,0,'x',boundary_conditions);
+    else deriche(sigma_x,0,'x',boundary_conditions);
   }
+  if (_height>1) _gmic_filter_axis(is_gaussian?1:0,sigma_y,'y',0,boundary_conditions,1);
+  if (_depth>1) _gmic_filter_axis(is_gaussian?1:0,sigma_z,'z',0,boundary_conditions,1);
+  if (_spectrum>1) _gmic_filter_axis(is_gaussian?1:0,sigma_c,'c',0,boundary_conditions,1);
   return *this;
 }
 
@@ -389,14 +834,157 @@ CImg<Tfloat> get_gmic_blur(const float sigma_x, const float sigma_y, const float
   return CImg<Tfloat>(*this,false).gmic_blur(sigma_x,sigma_y,sigma_z,sigma_c,boundary_conditions,is_gaussian);
 }
 
+CImg<T>& gmic_blur(const float sigma, const bool boundary_conditions, const bool is_gaussian) {
+  const float nsigma = sigma>=0?sigma:-sigma*cimg::max(_width,_height,_depth)/100;
+  return gmic_blur(nsigma,nsigma,nsigma,0,boundary_conditions,is_gaussian);
+}
+
+CImg<Tfloat> get_gmic_blur(const float sigma, const bool boundary_conditions, const bool is_gaussian) const {
+  return CImg<Tfloat>(*this,false).gmic_blur(sigma,boundary_conditions,is_gaussian);
+}
+
+// Blocked filtering of the 'y', 'z' and 'c'-axes (see '_gmic_filter_axis()'), disabled by setting
+// environment variable 'GMIC_BLOCKED_FILTERS' to '0' (e.g. to time the previous per-axis CImg filters).
+static bool gmic_is_blocked_filters() {
+  static int is_blocked = -1;
+  if (is_blocked<0) {
+    const char *const s = std::getenv("GMIC_BLOCKED_FILTERS");
+    is_blocked = s && *s=='0' && !s[1]?0:1;
+  }
+  return (bool)is_blocked;
+}
+
+// Apply 'deriche()' (filter=0), 'vanvliet()' (filter=1) or 'boxfilter()' (filter=2, iterated 'nb_iter' times)
+// along the 'y', 'z' or 'c'-axis of a float-valued image.
+// Blocks of adjacent columns are copied as contiguous rows of a small buffer, filtered along the 'x'-axis
+// with the same 1D filter, then copied back. This replaces a large-stride walk through the whole
+// image for each column (and for each iteration), gives the same result as filtering the float image
+// along the axis, and runs in parallel over the blocks.
+CImg<T>& _gmic_filter_axis(const unsigned int filter, const float sigma, const char axis,
+                           const unsigned int order, const bool boundary_conditions, const unsigned int nb_iter) {
+  const int N = axis=='y'?height():axis=='z'?depth():spectrum();
+  const float nsigma = sigma>=0?sigma:-sigma*N/100;
+  if (N<2 || (!order && filter<2 && nsigma<(filter?0.5f:0.1f))) return *this;
+  if (_width<16 || !gmic_is_blocked_filters()) { // Too few adjacent columns to gain from blocking, or disabled
+    if (filter==2) boxfilter(nsigma,order,axis,boundary_conditions,nb_iter);
+    else if (filter) vanvliet(nsigma,order,axis,boundary_conditions);
+    else deriche(nsigma,order,axis,boundary_conditions);
+    return *this;
+  }
+  const ulongT
+    wh = (ulongT)_width*_height, whd = wh*_depth,
+    off = axis=='y'?(ulongT)_width:axis=='z'?wh:whd;
+  const int
+    nb_planes = axis=='y'?depth()*spectrum():axis=='z'?height()*spectrum():height()*depth(),
+    bs = 64, nb_blocks = (width() + bs - 1)/bs;
+  cimg_pragma_openmp(parallel cimg_openmp_if(nb_planes*nb_blocks>1 && size()>=32768)) {
+    CImg<T> buf(N,bs);
+    cimg_pragma_openmp(for)
+    for (int k = 0; k<nb_planes*nb_blocks; ++k) {
+      const int p = k/nb_blocks, x0 = (k%nb_blocks)*bs, nx = std::min(bs,width() - x0);
+      const ulongT base = x0 + (axis=='y'?(p%_depth)*wh + (p/_depth)*whd:
+                                axis=='z'?(p%_height)*(ulongT)_width + (p/_height)*whd:
+                                (ulongT)p*_width);
+      CImg<T> block(buf._data,N,nx,1,1,true);
+      const T *ptrs = _data + base;
+      for (int n = 0; n<N; ++n, ptrs+=off) for (int j = 0; j<nx; ++j) block(n,j) = ptrs[j];
+      if (filter==2) block.boxfilter(nsigma,order,'x',boundary_conditions,nb_iter);
+      else if (filter) block.vanvliet(nsigma,order,'x',boundary_conditions);
+      else block.deriche(nsigma,order,'x',boundary_conditions);
+      T *ptrd = _data + base;
+      for (int n = 0; n<N; ++n, ptrd+=off) for (int j = 0; j<nx; ++j) ptrd[j] = block(n,j);
+    }
+  }
+  return *this;
+}
+
+// Same as 'blur_bilateral(guide,sigma_s,sigma_r,sampling_s,sampling_r)' (bilateral grid), but for 2D images,
+// the grid is filled by strips of image rows in parallel. Strips are aligned on rows of the grid,
+// so that they never update the same grid cells, and sums are computed in the same order as in the
+// sequential version.
+template<typename t>
+CImg<T>& gmic_blur_bilateral(const CImg<t>& guide, const float sigma_s, const float sigma_r,
+                             const float sampling_s, const float sampling_r) {
+  if (is_empty()) return *this;
+  if (_depth>1 || !is_sameXYZ(guide)) return blur_bilateral(guide,sigma_s,sigma_r,sampling_s,sampling_r);
+  const float _sigma_s = sigma_s>=0?sigma_s:-sigma_s*cimg::max(_width,_height,_depth)/100;
+  if (!_sigma_s) return *this;
+  t edge_min, edge_max = guide.max_min(edge_min);
+  if (edge_min==edge_max) return blur(_sigma_s,_sigma_s,_sigma_s);
+  const float
+    edge_delta = (float)(edge_max - edge_min),
+    _sigma_r = sigma_r>=0?sigma_r:-sigma_r*(edge_max - edge_min)/100,
+    _sampling_s = sampling_s?sampling_s:std::max(_sigma_s,1.f),
+    _sampling_r = sampling_r?sampling_r:std::max(_sigma_r,edge_delta/256),
+    derived_sigma_s = _sigma_s/_sampling_s,
+    derived_sigma_r = _sigma_r/_sampling_r;
+  const int
+    padding_s = (int)(2*derived_sigma_s) + 1,
+    padding_r = (int)(2*derived_sigma_r) + 1;
+  const unsigned int
+    bx = (unsigned int)((_width - 1)/_sampling_s + 1 + 2*padding_s),
+    by = (unsigned int)((_height - 1)/_sampling_s + 1 + 2*padding_s),
+    br = (unsigned int)(edge_delta/_sampling_r + 1 + 2*padding_r);
+
+  // Split image rows into strips that fill distinct rows of the grid.
+  const int rows_per_strip = std::max(1,height()/(int)(4*cimg::nb_cpus()));
+  CImg<int> strips(_height + 1);
+  unsigned int nb_strips = 0;
+  strips[nb_strips++] = 0;
+  for (int y = 1, y0 = 0; y<height(); ++y)
+    if (y - y0>=rows_per_strip && cimg::round(y/_sampling_s)!=cimg::round((y - 1)/_sampling_s))
+      strips[nb_strips++] = y0 = y;
+  strips[nb_strips] = height();
+
+  CImg<floatT> bgrid(bx,by,br,2);
+  cimg_forC(*this,c) {
+    const CImg<t> _guide = guide.get_shared_channel(c%guide._spectrum);
+    bgrid.fill(0);
+    cimg_pragma_openmp(parallel for schedule(dynamic,1) if (nb_strips>1 && size()>=65536))
+    for (int s = 0; s<(int)nb_strips; ++s) for (int y = strips[s]; y<strips[s + 1]; ++y) cimg_forX(*this,x) {
+          const T val = (*this)(x,y,c);
+          const float edge = (float)_guide(x,y);
+          const int
+            X = (int)cimg::round(x/_sampling_s) + padding_s,
+            Y = (int)cimg::round(y/_sampling_s) + padding_s,
+            R = (int)cimg::round((edge - edge_min)/_sampling_r) + padding_r;
+          bgrid(X,Y,R,0)+=(float)val;
+          bgrid(X,Y,R,1)+=1;
+        }
+    bgrid.blur(derived_sigma_s,derived_sigma_s,0,true).blur(0,0,derived_sigma_r,false);
+
+    cimg_pragma_openmp(parallel for cimg_openmp_collapse(2) cimg_openmp_if_size(size(),4096))
+    cimg_forXY(*this,x,y) {
+      const float edge = (float)_guide(x,y);
+      const float
+        X = x/_sampling_s + padding_s,
+        Y = y/_sampling_s + padding_s,
+        R = (edge - edge_min)/_sampling_r + padding_r;
+      const float bval0 = bgrid._linear_atXYZ(X,Y,R,0), bval1 = bgrid._linear_atXYZ(X,Y,R,1);
+      (*this)(x,y,c) = (T)(bval0/bval1);
+    }
+  }
+  return *this;
+}
+
+template<typename t>
+CImg<Tfloat> get_gmic_blur_bilateral(const CImg<t>& guide, const float sigma_s, const float sigma_r,
+                                     const float sampling_s, const float sampling_r) const {
+  return CImg<Tfloat>(*this,false).gmic_blur_bilateral(guide,sigma_s,sigma_r,sampling_s,sampling_r);
+}
+
 CImg<T>& gmic_blur_box(const float sigma_x, const float sigma_y, const float sigma_z, const float sigma_c,
                        const unsigned int order, const bool boundary_conditions,
                        const unsigned int nb_iter) {
   if (is_empty()) return *this;
+  if (!cimg::type<T>::is_float()) // Convert to float once, rather than for each axis
+    // (so, unlike the per-axis CImg filters, values are not rounded between two axes).
+    return CImg<Tfloat>(*this,false).gmic_blur_box(sigma_x,sigma_y,sigma_z,sigma_c,order,boundary_conditions,
+                                                   nb_iter).move_to(*this);
   if (_width>1) boxfilter(sigma_x,order,'x',boundary_conditions,nb_iter);
-  if (_height>1) boxfilter(sigma_y,order,'y',boundary_conditions,nb_iter);
-  if (_depth>1) boxfilter(sigma_z,order,'z',boundary_conditions,nb_iter);
-  if (_spectrum>1) boxfilter(sigma_c,order,'c',boundary_conditions,nb_iter);
+  if (_height>1) _gmic_filter_axis(2,sigma_y,'y',order,boundary_conditions,nb_iter);
+  if (_depth>1) _gmic_filter_axis(2,sigma_z,'z',order,boundary_conditions,nb_iter);
+  if (_spectrum>1) _gmic_filter_axis(2,sigma_c,'c',order,boundary_conditions,nb_iter);
   return *this;
 }
 
@@ -417,6 +1005,510 @@ CImg<Tfloat> get_gmic_blur_box(const float sigma, const unsigned int order, cons
   return CImg<Tfloat>(*this,false).gmic_blur_box(sigma,order,boundary_conditions,nb_iter);
 }
 
+// Same as 'blur_median(n,threshold)', but 2D images with integer values spanning at most 65536 values
+// are filtered with a sliding histogram (coarse and fine bins) along each row, by strips of rows in parallel.
+// The cost per pixel is then linear in 'n' instead of quadratic, plus a scan of the histogram bins
+// (about 32 steps for 256 values, 512 steps for 65536 values). For value ranges larger than 256, this scan
+// is only paid back for large windows (see 'bench_median' in 'resources/gmic_benchmarks.gmic').
+CImg<T>& gmic_blur_median(const unsigned int n, const float threshold=0) {
+  return get_gmic_blur_median(n,threshold).move_to(*this);
+}
+
+CImg<T> get_gmic_blur_median(const unsigned int n, const float threshold=0) const {
+  if (is_empty() || n<=5 || threshold>0 || _depth>1 || _height==1 || n>(1U<<16))
+    return get_blur_median(n,threshold);
+  T vmax = (T)0;
+  const T vmin = min_max(vmax);
+  const double range = (double)vmax - (double)vmin;
+  if (range>=65536 || (range>=256 && n<25) || (double)vmin<-1e15 || (double)vmax>1e15)
+    return get_blur_median(n,threshold);
+  if (cimg::type<T>::is_float()) cimg_for(*this,ptr,T)
+    if (*ptr!=(T)(cimg_int64)*ptr) return get_blur_median(n,threshold);
+
+  const int
+    W = width(), H = height(),
+    hr = (int)n/2, hl = (int)n - hr - 1;
+  const unsigned int
+    nb_bins = (unsigned int)((double)vmax - (double)vmin) + 1,
+    cshift = nb_bins>256?8:4, // Number of fine bins in a coarse bin is '2^cshift'
+    nb_coarse = (nb_bins>>cshift) + 1,
+    strip_height = std::max(8U,(unsigned int)H/(4*cimg::nb_cpus())),
+    nb_strips = (H + strip_height - 1)/strip_height;
+  CImg<T> res(_width,_height,1,_spectrum);
+
+  cimg_pragma_openmp(parallel for schedule(dynamic,1) if (nb_strips*_spectrum>1 && size()>=4096))
+  for (int job = 0; job<(int)(nb_strips*_spectrum); ++job) {
+    const int
+      c = job/(int)nb_strips,
+      y0 = (job%(int)nb_strips)*(int)strip_height,
+      y1 = std::min(H,y0 + (int)strip_height);
+    CImg<unsigned int> fine(nb_bins,1,1,1,0), coarse(nb_coarse,1,1,1,0);
+    for (int y = y0; y<y1; ++y) {
+      const int ny0 = std::max(0,y - hl), ny1 = std::min(H - 1,y + hr);
+      const unsigned int nb_rows = (unsigned int)(ny1 - ny0 + 1);
+      int nx1 = -1;
+      for (int x = 0; x<W; ++x) {
+        for (const int xm = std::min(W - 1,x + hr); nx1<xm; ) { // Add entering columns
+          const T *ptrs = data(++nx1,ny0,0,c);
+          for (unsigned int k = 0; k<nb_rows; ++k, ptrs+=W) {
+            const unsigned int b = (unsigned int)(*ptrs - vmin);
+            ++fine[b]; ++coarse[b>>cshift];
+          }
+        }
+        const int nx0 = std::max(0,x - hl);
+        if (x - hl - 1>=0) { // Remove leaving column
+          const T *ptrs = data(x - hl - 1,ny0,0,c);
+          for (unsigned int k = 0; k<nb_rows; ++k, ptrs+=W) {
+            const unsigned int b = (unsigned int)(*ptrs - vmin);
+            --fine[b]; --coarse[b>>cshift];
+          }
+        }
+        const unsigned int
+          count = (unsigned int)(nx1 - nx0 + 1)*nb_rows,
+          kth = count>>1;
+        const T val = (T)(vmin + _gmic_median_bin(fine,coarse,cshift,kth));
+        if (count%2) res(x,y,0,c) = val;
+        else res(x,y,0,c) = (T)((val + (T)(vmin + _gmic_median_bin(fine,coarse,cshift,kth - 1)))/2);
+      }
+      for (int x = std::max(0,W - 1 - hl); x<W; ++x) { // Empty histograms for next row
+        const T *ptrs = data(x,ny0,0,c);
+        for (unsigned int k = 0; k<nb_rows; ++k, ptrs+=W) {
+          const unsigned int b = (unsigned int)(*ptrs - vmin);
+          --fine[b]; --coarse[b>>cshift];
+        }
+      }
+    }
+  }
+  return res;
+}
+
+// Return index of the bin that contains the 'kth' smallest value of a histogram with coarse and fine bins.
+static unsigned int _gmic_median_bin(const CImg<unsigned int>& fine, const CImg<unsigned int>& coarse,
+                                     const unsigned int cshift, const unsigned int kth) {
+  unsigned int b = 0, cum = 0;
+  while (cum + coarse[b]<=kth) cum+=coarse[b++];
+  b<<=cshift;
+  while (cum + fine[b]<=kth) cum+=fine[b++];
+  return b;
+}
+
+// Same as 'correlate()' (or 'convolve()' if 'is_convolve==true'), but when kernel center, crop, strides and
+// dilations have their default values, 2D images are filtered either directly, with two 1D passes
+// (rank-1 kernels) or by FFT on tiles (overlap-save), whichever is predicted to be the fastest.
+// All paths use the same boundary conditions.
+template<typename t>
+CImg<T>& gmic_correlate(const CImg<t>& kernel, const unsigned int boundary_conditions, const bool is_normalized,
+                        const unsigned int channel_mode,
+                        const unsigned int xcenter, const unsigned int ycenter, const unsigned int zcenter,
+                        const unsigned int xstart, const unsigned int ystart, const unsigned int zstart,
+                        const unsigned int xend, const unsigned int yend, const unsigned int zend,
+                        const float xstride, const float ystride, const float zstride,
+                        const float xdilation, const float ydilation, const float zdilation,
+                        const bool is_convolve) {
+  if (is_normalized || channel_mode!=1 || xcenter!=~0U || ycenter!=~0U || zcenter!=~0U ||
+      xstart || ystart || zstart || xend!=~0U || yend!=~0U || zend!=~0U ||
+      xstride!=1 || ystride!=1 || zstride!=1 || xdilation!=1 || ydilation!=1 || zdilation!=1 ||
+      !_gmic_correlate_fast(kernel,boundary_conditions,is_convolve)) {
+    if (is_convolve) convolve(kernel,boundary_conditions,is_normalized,channel_mode,
+                              xcenter,ycenter,zcenter,xstart,ystart,zstart,xend,yend,zend,
+                              xstride,ystride,zstride,xdilation,ydilation,zdilation);
+    else correlate(kernel,boundary_conditions,is_normalized,channel_mode,
+                   xcenter,ycenter,zcenter,xstart,ystart,zstart,xend,yend,zend,
+                   xstride,ystride,zstride,xdilation,ydilation,zdilation);
+  }
+  return *this;
+}
+
+template<typename t>
+CImg<T> get_gmic_correlate(const CImg<t>& kernel, const unsigned int boundary_conditions, const bool is_normalized,
+                           const unsigned int channel_mode,
+                           const unsigned int xcenter, const unsigned int ycenter, const unsigned int zcenter,
+                           const unsigned int xstart, const unsigned int ystart, const unsigned int zstart,
+                           const unsigned int xend, const unsigned int yend, const unsigned int zend,
+                           const float xstride, const float ystride, const float zstride,
+                           const float xdilation, const float ydilation, const float zdilation,
+                           const bool is_convolve) const {
+  return (+*this).gmic_correlate(kernel,boundary_conditions,is_normalized,channel_mode,
+                                 xcenter,ycenter,zcenter,xstart,ystart,zstart,xend,yend,zend,
+                                 xstride,ystride,zstride,xdilation,ydilation,zdilation,is_convolve);
+}
+
+#ifdef cimg_use_fftw3
+// Fill 'res' with the correlation of the image by 2D kernel 'K', computed by FFT on tiles of size 'Tx x Ty'
+// (overlap-save: each tile is read with the margins needed by the kernel, and only its 'tw x th' values not
+// affected by the circular wrap-around are kept). Transforms use the cached real-to-complex FFTW plans,
+// executed concurrently on per-thread arrays. Return 'false' if no FFTW plan is available for the tile size.
+template<typename t>
+bool _gmic_correlate_fftw(const CImg<t>& K, CImg<T>& res, const unsigned int Tx, const unsigned int Ty,
+                          const int tw, const int th, const unsigned int boundary_conditions) const {
+  const fftw_plan
+    plan_r2c = _gmic_fftw_plan((int)Tx,(int)Ty,1),
+    plan_c2r = _gmic_fftw_plan((int)Tx,(int)Ty,1,true);
+  if (!plan_r2c || !plan_c2r) return false;
+  const int
+    W = width(), H = height(), cx = K.width()/2, cy = K.height()/2,
+    nx = (W + tw - 1)/tw, ny = (H + th - 1)/th, nb_jobs = nx*ny*spectrum();
+  const ulongT N = (ulongT)Tx*Ty, hN = (ulongT)(Tx/2 + 1)*Ty;
+
+  // Conjugate spectra of the kernel channels, scaled by '1/N' (normalization of the inverse transform).
+  CImg<double> kernel_fft((unsigned int)(2*hN),K._spectrum);
+  double *in = (double*)fftw_malloc(sizeof(double)*N);
+  fftw_complex *out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*hN);
+  cimg_forC(K,c) {
+    std::memset(in,0,sizeof(double)*N);
+    cimg_forXY(K,x,y) in[(ulongT)y*Tx + x] = (double)K(x,y,0,c);
+    fftw_execute_dft_r2c(plan_r2c,in,out);
+    double *const ptrd = kernel_fft.data(0,c);
+    for (ulongT k = 0; k<hN; ++k) { ptrd[2*k] = out[k][0]/N; ptrd[2*k + 1] = -out[k][1]/N; }
+  }
+  fftw_free(in);
+  fftw_free(out);
+
+  cimg_pragma_openmp(parallel if (nb_jobs>1)) {
+    double *const _in = (double*)fftw_malloc(sizeof(double)*N);
+    fftw_complex *const _out = (fftw_complex*)fftw_malloc(sizeof(fftw_complex)*hN);
+    cimg_pragma_openmp(for schedule(dynamic,1))
+    for (int job = 0; job<nb_jobs; ++job) {
+      const int
+        c = job/(nx*ny),
+        x0 = (job%nx)*tw,
+        y0 = ((job/nx)%ny)*th;
+      for (int j = 0; j<(int)Ty; ++j) {
+        const int yy = _gmic_boundary_index(y0 - cy + j,H,boundary_conditions);
+        double *const ptrd = _in + (ulongT)j*Tx;
+        for (int i = 0; i<(int)Tx; ++i) {
+          const int xx = yy<0?-1:_gmic_boundary_index(x0 - cx + i,W,boundary_conditions);
+          ptrd[i] = xx<0?0:(double)(*this)(xx,yy,0,c);
+        }
+      }
+      fftw_execute_dft_r2c(plan_r2c,_in,_out);
+      const double *const ptrk = kernel_fft.data(0,c%K._spectrum);
+      for (ulongT k = 0; k<hN; ++k) { // Multiply by conjugate of kernel spectrum
+        const double r = _out[k][0], i = _out[k][1], kr = ptrk[2*k], ki = ptrk[2*k + 1];
+        _out[k][0] = r*kr - i*ki;
+        _out[k][1] = r*ki + i*kr;
+      }
+      fftw_execute_dft_c2r(plan_c2r,_out,_in);
+      const int x1 = std::min(W,x0 + tw), y1 = std::min(H,y0 + th);
+      for (int y = y0; y<y1; ++y) for (int x = x0; x<x1; ++x)
+        res(x,y,0,c) = (T)_in[(ulongT)(y - y0)*Tx + x - x0];
+    }
+    fftw_free(_in);
+    fftw_free(_out);
+  }
+  return true;
+}
+#endif // #ifdef cimg_use_fftw3
+
+// Return index of the value to read at position 'i' of an axis of size 'n', for given boundary conditions
+// (-1 means value 0, for Dirichlet boundary conditions).
+static int _gmic_boundary_index(const int i, const int n, const unsigned int boundary_conditions) {
+  if (i>=0 && i<n) return i;
+  switch (boundary_conditions) {
+  case 0 : return -1; // Dirichlet
+  case 1 : return i<0?0:n - 1; // Neumann
+  case 2 : return cimg::mod(i,n); // Periodic
+  default : { // Mirror
+    const int n2 = 2*n, m = cimg::mod(i,n2);
+    return m<n?m:n2 - m - 1;
+  }
+  }
+}
+
+// Decompose 2D kernel 'K' as 'K(x,y) = u(y)*v(x)', if possible.
+static bool _gmic_kernel_rank1(const CImg<floatT>& K, CImg<floatT>& u, CImg<floatT>& v) {
+  int px = 0, py = 0;
+  float vmax = 0;
+  cimg_forXY(K,x,y) if (cimg::abs(K(x,y))>vmax) { vmax = cimg::abs(K(x,y)); px = x; py = y; }
+  u.assign(1,K._height,1,1,0);
+  v.assign(K._width,1,1,1,0);
+  if (!vmax) return true;
+  cimg_forY(K,y) u[y] = K(px,y);
+  cimg_forX(K,x) v[x] = K(x,py)/K(px,py);
+  cimg_forXY(K,x,y) if (cimg::abs(K(x,y) - u[y]*v[x])>1e-5f*vmax) return false;
+  return true;
+}
+
+template<typename t>
+bool _gmic_correlate_fast(const CImg<t>& kernel, const unsigned int boundary_conditions, const bool is_convolve) {
+  if (is_empty() || kernel.is_empty() || _depth>1 || kernel._depth>1 || !(kernel._width%2) || !(kernel._height%2) ||
+      (kernel._spectrum!=1 && kernel._spectrum!=_spectrum) || boundary_conditions>3)
+    return false;
+  CImg<floatT> K(kernel,false);
+  if (is_convolve) K.mirror("xy"); // Odd-sized kernel: convolution is a correlation with the mirrored kernel
+  const int W = width(), H = height(), kw = K.width(), kh = K.height(), cx = kw/2, cy = kh/2;
+
+  // Estimate cost per pixel of each method (in flops).
+  CImgList<floatT> us(K._spectrum), vs(K._spectrum);
+  bool is_separable = true;
+  cimg_forC(K,c) if (!_gmic_kernel_rank1(K.get_shared_channel(c),us[c],vs[c])) { is_separable = false; break; }
+  unsigned int Tx = 1, Ty = 1;
+  while (Tx<2U*kw || Tx<std::min(256U,(unsigned int)(W + kw - 1))) Tx<<=1;
+  while (Ty<2U*kh || Ty<std::min(256U,(unsigned int)(H + kh - 1))) Ty<<=1;
+  const int tw = (int)Tx - kw + 1, th = (int)Ty - kh + 1, nx = (W + tw - 1)/tw, ny = (H + th - 1)/th;
+  // FFT costs are the usual operation count '5*N*log2(N)' of a complex transform of size N, and half of it for
+  // the real-to-complex transforms done with FFTW. These are operation counts, not measured timings
+  // ('bench_correlate' in 'resources/gmic_benchmarks.gmic' compares the actual timings of the three paths).
+#ifdef cimg_use_fftw3
+  const double flops_fft = 2.5, flops_product = 3;
+#else
+  const double flops_fft = 5, flops_product = 6;
+#endif
+  const double
+    N = (double)Tx*Ty,
+    cost_direct = 2.*kw*kh,
+    cost_separable = is_separable?2.*(kw + kh) + 8:cimg::type<double>::inf(), // + Boundaries and temporary image
+    cost_fft = (2*flops_fft*N*std::log(N)/std::log(2.) + flops_product*N)*nx*ny/((double)W*H);
+  if (cost_direct<=cost_separable && cost_direct<=cost_fft) return false;
+
+  CImg<T> res(_width,_height,1,_spectrum);
+  if (cost_separable<=cost_fft) { // Two 1D passes
+    CImg<floatT> tmp(_width,_height);
+    cimg_forC(*this,c) {
+      const CImg<floatT> &u = us[c%us.width()], &v = vs[c%vs.width()];
+      cimg_pragma_openmp(parallel cimg_openmp_if_size(size(),4096)) {
+        CImg<floatT> line(W + kw - 1);
+        cimg_pragma_openmp(for)
+        cimg_forY(*this,y) {
+          const T *const ptrs = data(0,y,0,c);
+          cimg_forX(line,i) {
+            const int ind = _gmic_boundary_index(i - cx,W,boundary_conditions);
+            line[i] = ind<0?0:(floatT)ptrs[ind];
+          }
+          floatT *const ptrd = tmp.data(0,y);
+          cimg_forX(*this,x) {
+            floatT val = 0;
+            for (int i = 0; i<kw; ++i) val+=line[x + i]*v[i];
+            ptrd[x] = val;
+          }
+        }
+      }
+      cimg_pragma_openmp(parallel cimg_openmp_if_size(size(),4096)) {
+        CImg<floatT> acc(W);
+        cimg_pragma_openmp(for)
+        cimg_forY(*this,y) {
+          acc.fill(0);
+          for (int j = 0; j<kh; ++j) {
+            const int ind = _gmic_boundary_index(y + j - cy,H,boundary_conditions);
+            if (ind<0) continue;
+            const floatT *const ptrs = tmp.data(0,ind), w = u[j];
+            cimg_forX(*this,x) acc[x]+=w*ptrs[x];
+          }
+          T *const ptrd = res.data(0,y,0,c);
+          cimg_forX(*this,x) ptrd[x] = (T)acc[x];
+        }
+      }
+    }
+  } else { // FFT on tiles (overlap-save)
+#ifdef cimg_use_fftw3
+    if (_gmic_correlate_fftw(K,res,Tx,Ty,tw,th,boundary_conditions)) { res.move_to(*this); return true; }
+    const bool is_parallel = false; // 'CImg<T>::FFT()' runs under a global lock when FFTW is enabled
+#else
+    const bool is_parallel = true;
+#endif
+    cimg::unused(is_parallel);
+    CImgList<floatT> kernel_fft(2*K._spectrum,Tx,Ty,1,1,0);
+    cimg_forC(K,c) {
+      kernel_fft[2*c].draw_image(K.get_shared_channel(c));
+      CImg<floatT>::FFT(kernel_fft[2*c],kernel_fft[2*c + 1],false);
+    }
+    const int nb_jobs = nx*ny*spectrum();
+    cimg_pragma_openmp(parallel if (is_parallel && nb_jobs>1)) {
+      CImg<floatT> real(Tx,Ty), imag(Tx,Ty);
+      cimg_pragma_openmp(for schedule(dynamic,1))
+      for (int job = 0; job<nb_jobs; ++job) {
+        const int
+          c = job/(nx*ny),
+          x0 = (job%nx)*tw,
+          y0 = ((job/nx)%ny)*th;
+        const unsigned int kc = 2*(c%K._spectrum);
+        cimg_forY(real,j) {
+          const int yy = _gmic_boundary_index(y0 - cy + j,H,boundary_conditions);
+          cimg_forX(real,i) {
+            const int xx = yy<0?-1:_gmic_boundary_index(x0 - cx + i,W,boundary_conditions);
+            real(i,j) = xx<0?0:(floatT)(*this)(xx,yy,0,c);
+          }
+        }
+        imag.fill(0);
+        CImg<floatT>::FFT(real,imag,false,1);
+        const floatT *const ptrkr = kernel_fft[kc]._data, *const ptrki = kernel_fft[kc + 1]._data;
+        floatT *const ptrr = real._data, *const ptri = imag._data;
+        for (unsigned int k = 0; k<Tx*Ty; ++k) { // Multiply by conjugate of kernel spectrum
+          const floatT r = ptrr[k], i = ptri[k], kr = ptrkr[k], ki = ptrki[k];
+          ptrr[k] = r*kr + i*ki;
+          ptri[k] = i*kr - r*ki;
+        }
+        CImg<floatT>::FFT(real,imag,true,1);
+        const int x1 = std::min(W,x0 + tw), y1 = std::min(H,y0 + th);
+        for (int y = y0; y<y1; ++y) for (int x = x0; x<x1; ++x) res(x,y,0,c) = (T)real(x - x0,y - y0);
+      }
+    }
+  }
+  res.move_to(*this);
+  return true;
+}
+
+CImg<T>& gmic_dilate(const unsigned int sx, const unsigned int sy, const unsigned int sz=1) {
+  if (is_empty()) return *this;
+  if (std::max(sx,std::max(sy,sz))<8) return dilate(sx,sy,sz);
+  return _gmic_erode_dilate(sx,sy,sz,true,true);
+}
+
+CImg<T> get_gmic_dilate(const unsigned int sx, const unsigned int sy, const unsigned int sz=1) const {
+  return (+*this).gmic_dilate(sx,sy,sz);
+}
+
+CImg<T>& gmic_dilate(const unsigned int s) {
+  return gmic_dilate(s,s,_depth>1?s:1);
+}
+
+CImg<T> get_gmic_dilate(const unsigned int s) const {
+  return (+*this).gmic_dilate(s);
+}
+
+template<typename t>
+CImg<T>& gmic_dilate(const CImg<t>& kernel, const bool boundary_conditions, const bool is_real) {
+  if (is_empty()) return *this;
+  if (!_gmic_is_flat_box(kernel,boundary_conditions,is_real)) return dilate(kernel,boundary_conditions,is_real);
+  return _gmic_erode_dilate(kernel._width,kernel._height,kernel._depth,true,boundary_conditions);
+}
+
+template<typename t>
+CImg<T> get_gmic_dilate(const CImg<t>& kernel, const bool boundary_conditions, const bool is_real) const {
+  return (+*this).gmic_dilate(kernel,boundary_conditions,is_real);
+}
+
+CImg<T>& gmic_erode(const unsigned int sx, const unsigned int sy, const unsigned int sz=1) {
+  if (is_empty()) return *this;
+  if (std::max(sx,std::max(sy,sz))<8) return erode(sx,sy,sz);
+  return _gmic_erode_dilate(sx,sy,sz,false,true);
+}
+
+CImg<T> get_gmic_erode(const unsigned int sx, const unsigned int sy, const unsigned int sz=1) const {
+  return (+*this).gmic_erode(sx,sy,sz);
+}
+
+CImg<T>& gmic_erode(const unsigned int s) {
+  return gmic_erode(s,s,_depth>1?s:1);
+}
+
+CImg<T> get_gmic_erode(const unsigned int s) const {
+  return (+*this).gmic_erode(s);
+}
+
+template<typename t>
+CImg<T>& gmic_erode(const CImg<t>& kernel, const bool boundary_conditions, const bool is_real) {
+  if (is_empty()) return *this;
+  if (!_gmic_is_flat_box(kernel,boundary_conditions,is_real)) return erode(kernel,boundary_conditions,is_real);
+  return _gmic_erode_dilate(kernel._width,kernel._height,kernel._depth,false,boundary_conditions);
+}
+
+template<typename t>
+CImg<T> get_gmic_erode(const CImg<t>& kernel, const bool boundary_conditions, const bool is_real) const {
+  return (+*this).gmic_erode(kernel,boundary_conditions,is_real);
+}
+
+// Return 'true' if a binary erosion/dilation with specified kernel is the same as with a box of the kernel size
+// (i.e. kernel has only non-zero values, and odd dimensions so that its orientation does not matter).
+template<typename t>
+bool _gmic_is_flat_box(const CImg<t>& kernel, const bool boundary_conditions, const bool is_real) const {
+  if (is_real || !boundary_conditions || kernel.is_empty() || kernel.size()<16 ||
+      !(kernel._width%2) || !(kernel._height%2) || !(kernel._depth%2))
+    return false;
+  cimg_for(kernel,ptr,t) if (!*ptr) return false;
+  return true;
+}
+
+// Erode or dilate image by a box of size 'sx x sy x sz', as separable running min/max along each axis,
+// with Dirichlet (value 0) or Neumann boundary conditions.
+// For even sizes, the box is placed as in 'CImg<T>::erode()' and 'CImg<T>::dilate()', i.e. windows
+// [p - s + s/2 + 1,p + s/2] for erosion and the mirrored [p - s/2,p + s - s/2 - 1] for dilation.
+CImg<T>& _gmic_erode_dilate(const unsigned int sx, const unsigned int sy, const unsigned int sz,
+                            const bool is_dilate, const bool boundary_conditions) {
+  if (sx>1) _gmic_erode_dilate_axis(0,is_dilate?sx/2:sx - sx/2 - 1,is_dilate?sx - sx/2 - 1:sx/2,
+                                    is_dilate,boundary_conditions);
+  if (sy>1) _gmic_erode_dilate_axis(1,is_dilate?sy/2:sy - sy/2 - 1,is_dilate?sy - sy/2 - 1:sy/2,
+                                    is_dilate,boundary_conditions);
+  if (sz>1) _gmic_erode_dilate_axis(2,is_dilate?sz/2:sz - sz/2 - 1,is_dilate?sz - sz/2 - 1:sz/2,
+                                    is_dilate,boundary_conditions);
+  return *this;
+}
+
+// Replace each value by the min (or max) of values in [p - a,p + b] along specified axis (0='x', 1='y', 2='z').
+// Use the algorithm of Van Herk/Gil-Werman (3 comparisons per value, whatever the window size),
+// applied on tiles of up to 64 neighboring lines at once, so that inner loops run on contiguous values.
+CImg<T>& _gmic_erode_dilate_axis(const unsigned int axis, const unsigned int a, const unsigned int b,
+                                 const bool is_dilate, const bool boundary_conditions) {
+  const int L = axis==0?width():axis==1?height():depth();
+  if (L<=1 || (!a && !b)) return *this;
+  const ulongT
+    M = axis==0?1:axis==1?(ulongT)_width:(ulongT)_width*_height, // Offset between two consecutive values of a line
+    slab_siz = M*L,
+    tw = std::min((ulongT)64,M),
+    nb_tiles = (M + tw - 1)/tw,
+    nb_groups = (size()/slab_siz)*nb_tiles;
+  const unsigned int
+    na = std::min(a,(unsigned int)L), nb = std::min(b,(unsigned int)L), k = na + nb + 1,
+    N = ((L + k - 2)/k + 1)*k; // Padded line length, multiple of 'k'
+  const T value_out = boundary_conditions?(is_dilate?cimg::type<T>::min():cimg::type<T>::max()):(T)0;
+
+  cimg_pragma_openmp(parallel if (nb_groups>1 && size()>=65536))
+  {
+    CImg<T> g((unsigned int)(N*tw)), h((unsigned int)(N*tw));
+    cimg_pragma_openmp(for schedule(dynamic,16))
+    for (longT grp = 0; grp<(longT)nb_groups; ++grp) {
+      const ulongT j0 = (grp%nb_tiles)*tw;
+      const unsigned int m = (unsigned int)std::min(tw,M - j0);
+      T *const ptrb = _data + (grp/nb_tiles)*slab_siz + j0;
+
+      // Running min/max, forward (in 'g') and backward (in 'h') inside each block of 'k' values.
+      for (unsigned int i = 0; i<N; ++i) {
+        const int p = (int)i - (int)na;
+        const T *const ptrs = p>=0 && p<L?ptrb + p*M:0;
+        T *const ptrd = g._data + (ulongT)i*m;
+        if (i%k) {
+          const T *const ptrp = ptrd - m;
+          if (is_dilate) {
+            if (ptrs) for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::max(ptrp[j],ptrs[j]);
+            else for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::max(ptrp[j],value_out);
+          } else {
+            if (ptrs) for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::min(ptrp[j],ptrs[j]);
+            else for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::min(ptrp[j],value_out);
+          }
+        } else if (ptrs) std::memcpy(ptrd,ptrs,m*sizeof(T));
+        else for (unsigned int j = 0; j<m; ++j) ptrd[j] = value_out;
+      }
+      for (int i = (int)N - 1; i>=0; --i) {
+        const int p = i - (int)na;
+        const T *const ptrs = p>=0 && p<L?ptrb + p*M:0;
+        T *const ptrd = h._data + (ulongT)i*m;
+        if ((i + 1)%k) {
+          const T *const ptrp = ptrd + m;
+          if (is_dilate) {
+            if (ptrs) for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::max(ptrp[j],ptrs[j]);
+            else for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::max(ptrp[j],value_out);
+          } else {
+            if (ptrs) for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::min(ptrp[j],ptrs[j]);
+            else for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::min(ptrp[j],value_out);
+          }
+        } else if (ptrs) std::memcpy(ptrd,ptrs,m*sizeof(T));
+        else for (unsigned int j = 0; j<m; ++j) ptrd[j] = value_out;
+      }
+
+      // Window [p - a,p + b] is the union of a block suffix and the next block prefix.
+      for (int p = 0; p<L; ++p) {
+        const T
+          *const ptrh = h._data + (ulongT)p*m,
+          *const ptrg = g._data + (ulongT)(p + k - 1)*m;
+        T *const ptrd = ptrb + p*M;
+        if (is_dilate) for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::max(ptrh[j],ptrg[j]);
+        else for (unsigned int j = 0; j<m; ++j) ptrd[j] = std::min(ptrh[j],ptrg[j]);
+      }
+    }
+  }
+  return *this;
+}
+
 CImg<T>& gmic_discard(const char *const axes) {
   for (const char *s = axes; *s; ++s) discard(*s);
   return *this;
@@ -485,6 +1577,294 @@ CImg<T> get_gmic_invert_endianness(const char *const stype) const {
   return (+*this).gmic_invert_endianness(stype);
 }
 
+CImg<T>& gmic_label(const bool is_high_connectivity, const Tfloat tolerance) {
+  return get_gmic_label(is_high_connectivity,tolerance).move_to(*this);
+}
+
+// Same as 'get_label(is_high_connectivity,tolerance)', with a block-parallel union-find.
+// Each channel is split into slabs of rows (or of slices for 3D images), labeled independently in parallel,
+// then equivalences between neighboring slabs are merged. As in CImg, the root of each component is its
+// first pixel (in raster order), so labels are numbered in the same order as with 'get_label()'.
+CImg<ulongT> get_gmic_label(const bool is_high_connectivity, const Tfloat tolerance) const {
+  if (is_empty()) return CImg<ulongT>();
+
+  // Create list of 'forward' neighbors.
+  int dx[13], dy[13], dz[13];
+  unsigned int nb = 0;
+  for (int k = 0; k<=(_depth>1?1:0); ++k)
+    for (int j = -1; j<=1; ++j)
+      for (int i = -1; i<=1; ++i)
+        if ((k || j>0 || (!j && i>0)) && (is_high_connectivity || cimg::abs(i) + cimg::abs(j) + k==1)) {
+          dx[nb] = i; dy[nb] = j; dz[nb++] = k;
+        }
+
+  const bool is_3d = _depth>1;
+  const int nb_units = is_3d?depth():height(); // Slabs are made of rows (2D) or slices (3D)
+  const ulongT
+    wh = (ulongT)_width*_height, whd = wh*_depth,
+    unit_size = is_3d?wh:(ulongT)_width;
+  const int
+    units_per_slab = std::max(1,nb_units/(4*(int)cimg::nb_cpus())),
+    nb_slabs = (nb_units + units_per_slab - 1)/units_per_slab;
+  CImg<ulongT> res(_width,_height,_depth,_spectrum);
+
+  // Merge pixels of units 'ua' to 'ub' with their similar neighbors, either inside range '[p0,p1)' or
+  // (if 'is_crossing') across position 'p0'.
+#define _gmic_label_edges(ua,ub,p0,p1,is_crossing) \
+  for (int z = is_3d?ua:0; z<=(is_3d?ub:0); ++z) \
+    for (int y = is_3d?0:ua; y<=(is_3d?height() - 1:ub); ++y) \
+      for (int x = 0; x<width(); ++x) { \
+        const ulongT p = x + y*(ulongT)_width + z*wh; \
+        for (unsigned int n = 0; n<nb; ++n) { \
+          const int nx = x + dx[n], ny = y + dy[n], nz = z + dz[n]; \
+          if (nx<0 || nx>=width() || ny<0 || ny>=height() || nz>=depth()) continue; \
+          const ulongT q = nx + ny*(ulongT)_width + nz*wh; \
+          if ((is_crossing?(p<p0)!=(q<p0):q>=p0 && q<p1) && \
+              cimg::abs((Tfloat)ptrs[p] - (Tfloat)ptrs[q])<=tolerance) \
+            _gmic_label_union(parent,p,q); \
+        } \
+      }
+
+  cimg_forC(*this,c) {
+    const T *const ptrs = data(0,0,0,c);
+    ulongT *const parent = res.data(0,0,0,c);
+
+    // Label each slab independently.
+    cimg_pragma_openmp(parallel for schedule(dynamic,1) if (nb_slabs>1 && whd>=65536))
+    for (int slab = 0; slab<nb_slabs; ++slab) {
+      const int u0 = slab*units_per_slab, u1 = std::min(nb_units,u0 + units_per_slab) - 1;
+      const ulongT p0 = u0*unit_size, p1 = (u1 + 1)*unit_size;
+      for (ulongT p = p0; p<p1; ++p) parent[p] = p;
+      _gmic_label_edges(u0,u1,p0,p1,false);
+    }
+
+    // Merge equivalences across slab boundaries.
+    for (int slab = 1; slab<nb_slabs; ++slab) {
+      const int ub = slab*units_per_slab;
+      const ulongT pb = ub*unit_size;
+      _gmic_label_edges(ub - 1,ub,pb,pb,true);
+    }
+
+    // Resolve equivalences (parents always precede their children).
+    ulongT counter = 0;
+    for (ulongT p = 0; p<whd; ++p) parent[p] = parent[p]==p?counter++:parent[parent[p]];
+  }
+#undef _gmic_label_edges
+  return res;
+}
+
+// Union-find operations for 'get_gmic_label()'. The root of a set is its smallest element.
+static ulongT _gmic_label_find(ulongT *const parent, ulongT p) {
+  while (parent[p]!=p) { parent[p] = parent[parent[p]]; p = parent[p]; } // Path halving
+  return p;
+}
+
+static void _gmic_label_union(ulongT *const parent, const ulongT p, const ulongT q) {
+  const ulongT rp = _gmic_label_find(parent,p), rq = _gmic_label_find(parent,q);
+  if (rp<rq) parent[rq] = rp;
+  else if (rq<rp) parent[rp] = rq;
+}
+
+// Estimate correspondence map between instance image and 'patch_image', with a parallel version of the
+// PatchMatch algorithm. Map is computed by strips of 32 rows, each strip being swept in scanline order
+// (reversed at odd iterations) and propagating matches only from neighbors inside the strip. Strip
+// boundaries are shifted by half a strip from one pair of iterations to the next, so that matches also
+// propagate across strips. Random search uses a random stream per pixel and iteration, and occurrences
+// of matched patches are counted once per iteration, so the result does not depend on the number of threads.
+CImg<intT> _gmic_matchpatch(const CImg<T>& patch_image,
+                            const unsigned int patch_width,
+                            const unsigned int patch_height,
+                            const unsigned int patch_depth,
+                            const unsigned int nb_iterations,
+                            const unsigned int nb_randoms,
+                            const float occ_penalization,
+                            const CImg<T>& initialization,
+                            CImg<floatT>& score) const {
+  if (is_empty()) return CImg<intT>::const_empty();
+  if (patch_image._spectrum!=_spectrum)
+    throw CImgArgumentException(_cimg_instance
+                                "matchpatch(): Instance image and specified patch image (%u,%u,%u,%u,%p) "
+                                "have different spectrums.",
+                                cimg_instance,
+                                patch_image._width,patch_image._height,patch_image._depth,patch_image._spectrum,
+                                patch_image._data);
+  if (patch_width>_width || patch_height>_height || patch_depth>_depth)
+    throw CImgArgumentException(_cimg_instance
+                                "matchpatch(): Specified patch size %ux%ux%u is bigger than the dimensions "
+                                "of the instance image.",
+                                cimg_instance,patch_width,patch_height,patch_depth);
+  if (patch_width>patch_image._width || patch_height>patch_image._height || patch_depth>patch_image._depth)
+    throw CImgArgumentException(_cimg_instance
+                                "matchpatch(): Specified patch size %ux%ux%u is bigger than the dimensions "
+                                "of the patch image (%u,%u,%u,%u,%p).",
+                                cimg_instance,patch_width,patch_height,patch_depth,
+                                patch_image._width,patch_image._height,patch_image._depth,patch_image._spectrum,
+                                patch_image._data);
+  const bool is_3d = _depth>1 || patch_image._depth>1;
+  const unsigned int nb_coords = is_3d?3:2;
+  if (initialization &&
+      (initialization._width!=_width || initialization._height!=_height || initialization._depth!=_depth ||
+       initialization._spectrum!=nb_coords))
+    throw CImgArgumentException(_cimg_instance
+                                "matchpatch(): Specified initialization image (%u,%u,%u,%u,%p) has invalid "
+                                "dimensions considering instance image.",
+                                cimg_instance,
+                                initialization._width,initialization._height,initialization._depth,
+                                initialization._spectrum,initialization._data);
+
+  const int
+    W = width(), H = height(), D = depth(),
+    PW = patch_image.width(), PH = patch_image.height(), PD = patch_image.depth(),
+    psw = (int)patch_width, psw1 = psw/2, psw2 = psw - psw1 - 1,
+    psh = (int)patch_height, psh1 = psh/2, psh2 = psh - psh1 - 1,
+    psd = (int)patch_depth, psd1 = psd/2, psd2 = psd - psd1 - 1;
+  const CImg<floatT> img1(get_permute_axes("cxyz")), img2(patch_image.get_permute_axes("cxyz"));
+  CImg<intT> a_map(_width,_height,_depth,nb_coords);
+  CImg<uintT> occ;
+  if (occ_penalization) occ.assign(PW,PH,PD,1,0); // No penalization for the initial matches
+  score.assign(_width,_height,_depth);
+  const cimg_uint64 seed = (cimg_uint64)cimg::rand(0,4294967295.);
+  const float inf = cimg::type<float>::inf();
+
+  // Position of a pixel inside the patch centered on it, shifted so that the patch fits in the image.
+#define _gmic_matchpatch_bounds(x,y,z) \
+  const int \
+    cx1 = x<=psw1?x:(x<W - psw2?psw1:psw + x - W), cx2 = psw - cx1 - 1, \
+    cy1 = y<=psh1?y:(y<H - psh2?psh1:psh + y - H), cy2 = psh - cy1 - 1, \
+    cz1 = z<=psd1?z:(z<D - psd2?psd1:psd + z - D), cz2 = psd - cz1 - 1, \
+    u0 = cx1, u1 = PW - 1 - cx2, v0 = cy1, v1 = PH - 1 - cy2, w0 = cz1, w1 = PD - 1 - cz2
+#define _gmic_matchpatch_score(u,v,w,max_score) \
+  _gmic_matchpatch_ssd(img1,img2,occ,patch_width,patch_height,patch_depth, \
+                       x - cx1,y - cy1,z - cz1,u - cx1,v - cy1,w - cz1,u,v,w, \
+                       occ_penalization,max_score)
+#define _gmic_matchpatch_try(_u,_v,_w) { \
+  const int u = _u, v = _v, w = _w; \
+  if (u!=best_u || v!=best_v || w!=best_w) { \
+    const float s = _gmic_matchpatch_score(u,v,w,best_score); \
+    if (s<best_score) { best_u = u; best_v = v; best_w = w; best_score = s; } \
+  } \
+}
+
+  // Initialize correspondence map.
+  cimg_pragma_openmp(parallel for cimg_openmp_if_size(size(),1024))
+  for (int yz = 0; yz<H*D; ++yz) {
+    const int y = yz%H, z = yz/H;
+    cimg_forX(*this,x) {
+      _gmic_matchpatch_bounds(x,y,z);
+      int u, v, w;
+      if (initialization) {
+        u = cimg::cut((int)initialization(x,y,z,0),u0,u1);
+        v = cimg::cut((int)initialization(x,y,z,1),v0,v1);
+        w = is_3d?cimg::cut((int)initialization(x,y,z,2),w0,w1):0;
+      } else {
+        cimg_uint64 rng = _gmic_mix64(seed ^ _gmic_mix64(((cimg_uint64)yz*W + x)*(nb_iterations + 1)));
+        u = u0 + (int)(_gmic_rand64(rng)%(cimg_uint64)(u1 - u0 + 1));
+        v = v0 + (int)(_gmic_rand64(rng)%(cimg_uint64)(v1 - v0 + 1));
+        w = w0 + (int)(_gmic_rand64(rng)%(cimg_uint64)(w1 - w0 + 1));
+      }
+      a_map(x,y,z,0) = u; a_map(x,y,z,1) = v; if (is_3d) a_map(x,y,z,2) = w;
+      score(x,y,z) = _gmic_matchpatch_score(u,v,w,inf);
+    }
+  }
+
+  // Start iteration loop.
+  const int strip = 32;
+  for (unsigned int iter = 0; iter<nb_iterations; ++iter) {
+    const bool is_backward = iter%2;
+    const int
+      offset = ((iter + 1)/2)%2?strip/2:0,
+      nb_strips = (H + offset + strip - 1)/strip,
+      dir = is_backward?1:-1; // Direction of already processed neighbors
+    if (occ_penalization) { // Count occurrences of each matched patch
+      occ.assign(PW,PH,PD,1,0);
+      cimg_forXYZ(a_map,x,y,z) ++occ(a_map(x,y,z,0),a_map(x,y,z,1),is_3d?a_map(x,y,z,2):0);
+    }
+    cimg_pragma_openmp(parallel for schedule(dynamic,1) if (nb_strips>1 && size()>=4096))
+    for (int st = 0; st<nb_strips; ++st) {
+      const int ys0 = std::max(0,st*strip - offset), ys1 = std::min(H,(st + 1)*strip - offset) - 1;
+      for (int _z = 0; _z<D; ++_z) for (int _y = ys0; _y<=ys1; ++_y) for (int _x = 0; _x<W; ++_x) {
+            const int
+              x = is_backward?W - 1 - _x:_x,
+              y = is_backward?ys0 + ys1 - _y:_y,
+              z = is_backward?D - 1 - _z:_z;
+            _gmic_matchpatch_bounds(x,y,z);
+            int
+              best_u = a_map(x,y,z,0), best_v = a_map(x,y,z,1), best_w = is_3d?a_map(x,y,z,2):0;
+            float best_score = occ_penalization?_gmic_matchpatch_score(best_u,best_v,best_w,inf):score(x,y,z);
+
+            // Propagation.
+            const int nx = x + dir, ny = y + dir, nz = z + dir;
+            if (nx>=0 && nx<W)
+              _gmic_matchpatch_try(cimg::cut(a_map(nx,y,z,0) - dir,u0,u1),
+                                   cimg::cut(a_map(nx,y,z,1),v0,v1),
+                                   is_3d?cimg::cut(a_map(nx,y,z,2),w0,w1):0);
+            if (ny>=ys0 && ny<=ys1)
+              _gmic_matchpatch_try(cimg::cut(a_map(x,ny,z,0),u0,u1),
+                                   cimg::cut(a_map(x,ny,z,1) - dir,v0,v1),
+                                   is_3d?cimg::cut(a_map(x,ny,z,2),w0,w1):0);
+            if (nz>=0 && nz<D)
+              _gmic_matchpatch_try(cimg::cut(a_map(x,y,nz,0),u0,u1),
+                                   cimg::cut(a_map(x,y,nz,1),v0,v1),
+                                   cimg::cut(a_map(x,y,nz,2) - dir,w0,w1));
+
+            // Random search, in windows of decreasing size around the best match.
+            cimg_uint64 rng = _gmic_mix64(seed ^ _gmic_mix64((((cimg_uint64)z*H + y)*W + x)*(nb_iterations + 1) +
+                                                             iter + 1));
+            float dw = (float)PW, dh = (float)PH, dd = (float)PD;
+            for (unsigned int i = 0; i<nb_randoms; ++i) {
+              const int
+                ua = std::max(u0,(int)(best_u - dw)), ub = std::min(u1,(int)(best_u + dw)),
+                va = std::max(v0,(int)(best_v - dh)), vb = std::min(v1,(int)(best_v + dh)),
+                wa = std::max(w0,(int)(best_w - dd)), wb = std::min(w1,(int)(best_w + dd));
+              _gmic_matchpatch_try(ua + (int)(_gmic_rand64(rng)%(cimg_uint64)(ub - ua + 1)),
+                                   va + (int)(_gmic_rand64(rng)%(cimg_uint64)(vb - va + 1)),
+                                   wa + (int)(_gmic_rand64(rng)%(cimg_uint64)(wb - wa + 1)));
+              dw = std::max(5.f,dw*0.5f); dh = std::max(5.f,dh*0.5f); dd = std::max(5.f,dd*0.5f);
+            }
+            a_map(x,y,z,0) = best_u; a_map(x,y,z,1) = best_v; if (is_3d) a_map(x,y,z,2) = best_w;
+            score(x,y,z) = best_score;
+          }
+    }
+  }
+#undef _gmic_matchpatch_try
+#undef _gmic_matchpatch_score
+#undef _gmic_matchpatch_bounds
+  return a_map;
+}
+
+// Return the (occurrence-penalized) sum of squared differences between two patches of images stored with
+// interleaved channels, or 'max_score' as soon as the sum exceeds it.
+static float _gmic_matchpatch_ssd(const CImg<floatT>& img1, const CImg<floatT>& img2, const CImg<uintT>& occ,
+                                  const unsigned int psizew, const unsigned int psizeh, const unsigned int psized,
+                                  const int x1, const int y1, const int z1,
+                                  const int x2, const int y2, const int z2,
+                                  const int xo, const int yo, const int zo,
+                                  const float occ_penalization, const float max_score) {
+  const unsigned int psizewc = psizew*img1._width;
+  float ssd = 0;
+  for (unsigned int k = 0; k<psized; ++k)
+    for (unsigned int j = 0; j<psizeh; ++j) {
+      const float *const p1 = img1.data(0,x1,y1 + j,z1 + k), *const p2 = img2.data(0,x2,y2 + j,z2 + k);
+      float _ssd = 0;
+      for (unsigned int i = 0; i<psizewc; ++i) _ssd+=cimg::sqr(p1[i] - p2[i]);
+      ssd+=_ssd;
+      if (ssd>max_score) return max_score;
+    }
+  return occ_penalization==0?ssd:
+    cimg::sqr(std::sqrt(ssd) + occ_penalization*psizewc*psizeh*psized*occ(xo,yo,zo)/100);
+}
+
+// Hash function and random generator (SplitMix64) used for per-pixel random streams.
+static cimg_uint64 _gmic_mix64(cimg_uint64 x) {
+  x = (x^(x>>30))*(((cimg_uint64)0xBF58476DU<<32) | 0x1CE4E5B9U);
+  x = (x^(x>>27))*(((cimg_uint64)0x94D049BBU<<32) | 0x133111EBU);
+  return x^(x>>31);
+}
+
+static cimg_uint64 _gmic_rand64(cimg_uint64& state) {
+  return _gmic_mix64(state+=(((cimg_uint64)0x9E3779B9U<<32) | 0x7F4A7C15U));
+}
+
 CImg<T>& gmic_matchpatch(const CImg<T>& patch_image,
                          const unsigned int patch_width,
                          const unsigned int patch_height,
@@ -508,12 +1888,11 @@ CImg<T> get_gmic_matchpatch(const CImg<T>& patch_image,
                             const bool is_score,
                             const CImg<T> *const initialization) const {
   CImg<floatT> score, res;
-  res = _matchpatch(patch_image,patch_width,patch_height,patch_depth,
-                    nb_iterations,nb_randoms,occ_penalization,
-                    initialization?*initialization:CImg<T>::const_empty(),
-                    is_score,is_score?score:CImg<floatT>::empty());
+  res = _gmic_matchpatch(patch_image,patch_width,patch_height,patch_depth,
+                         nb_iterations,nb_randoms,occ_penalization,
+                         initialization?*initialization:CImg<T>::const_empty(),score);
   const unsigned int s = res._spectrum;
-  if (score) res.resize(-100,-100,-100,s + 1,0).draw_image(0,0,0,s,score);
+  if (is_score && res) res.resize(-100,-100,-100,s + 1,0).draw_image(0,0,0,s,score);
   return res;
 }
 
@@ -524,8 +1903,8 @@ const CImg<T>& gmic_print(const char *const title, const bool is_debug,
   if (is_valid && !is_empty()) get_stats().move_to(st);
   const ulongT siz = size(), msiz = siz*sizeof(T), siz1 = siz - 1,
     mdisp = msiz<8*1024?0U:msiz<8*1024*1024?1U:2U,
-    wh = _width*_height, whd = _width*_height*_depth,
-    w1 = _width - 1, wh1 = _width*_height - 1, whd1 = _width*_height*_depth - 1;
+    wh = (ulongT)_width*_height, whd = wh*_depth,
+    w1 = _width - 1, wh1 = wh - 1, whd1 = whd - 1;
 
   std::fprintf(cimg::output(),"%s%s%s%s:\n  %ssize%s = (%u,%u,%u,%u) [%lu %s of %s%ss].\n  %sdata%s = %s",
                cimg::t_magenta,cimg::t_bold,title,cimg::t_normal,
@@ -574,9 +1953,46 @@ CImg<T>& gmic_set(const double value,
   return *this;
 }
 
-CImg<T> get_gmic_set(const double value,
-                     const int x, const int y, const int z, const int v) const {
-  return (+*this).gmic_set(value,x,y,z,v);
+CImg<T> get_gmic_set(const double value,
+                     const int x, const int y, const int z, const int v) const {
+  return (+*this).gmic_set(value,x,y,z,v);
+}
+
+// Allocation policy for large image buffers, set by environment variable 'GMIC_MEMORY_POLICY':
+// 0=default, 1=transparent huge pages, 2=transparent huge pages + parallel first-touch of new images.
+// The variable is read once.
+static unsigned int gmic_memory_policy() {
+  static const unsigned int policy = _gmic_memory_policy();
+  return policy;
+}
+
+static unsigned int _gmic_memory_policy() {
+  const char *const s = std::getenv("GMIC_MEMORY_POLICY");
+  return s && *s>='0' && *s<='2' && !s[1]?(unsigned int)(*s - '0'):0;
+}
+
+// Advise the kernel to back the pixel buffer with transparent huge pages (Linux only).
+const CImg<T>& gmic_advise_hugepages() const {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const ulongT hsiz = (ulongT)2*1024*1024, bsiz = size()*sizeof(T);
+  if (bsiz<2*hsiz || !gmic_memory_policy()) return *this;
+  const ulongT
+    p0 = ((ulongT)(void*)_data + hsiz - 1)&~(hsiz - 1),
+    p1 = ((ulongT)(void*)_data + bsiz)&~(hsiz - 1);
+  if (p1>p0) madvise((void*)p0,(size_t)(p1 - p0),MADV_HUGEPAGE);
+#endif // #if defined(__linux__) && defined(MADV_HUGEPAGE)
+  return *this;
+}
+
+// Fill a freshly allocated buffer with 'value', with the same OpenMP schedule as the
+// 'cimg_openmp_collapse(3)' loops over (c,z,y), so that memory pages are placed on the NUMA nodes
+// of the threads that process them afterwards (pages already written are not moved).
+CImg<T>& gmic_first_touch(const T& value) {
+  gmic_advise_hugepages();
+  if (gmic_memory_policy()<2 || size()*sizeof(T)<((ulongT)4*1024*1024)) return fill(value);
+  cimg_pragma_openmp(parallel for cimg_openmp_collapse(3) cimg_openmp_if_size(size(),4096))
+  cimg_forYZC(*this,y,z,c) { T *ptrd = data(0,y,z,c); cimg_forX(*this,x) *(ptrd++) = value; }
+  return *this;
 }
 
 CImg<T>& gmic_shift(const float delta_x, const float delta_y=0, const float delta_z=0, const float delta_c=0,
@@ -610,6 +2026,7 @@ CImg<T> get_gmic_shift(const float delta_x, const float delta_y=0, const float d
 CImg<T> _gmic_shift(const float delta_x, const float delta_y=0, const float delta_z=0, const float delta_c=0,
                     const unsigned int boundary_conditions=0) const {
   CImg<T> res(_width,_height,_depth,_spectrum);
+  res.gmic_advise_hugepages(); // First touch is done by the parallel loops below
   if (delta_c!=0) // 4D shift
     switch (boundary_conditions) {
     case 3 : { // Mirror
@@ -963,13 +2380,30 @@ CImg<T> get_inpaint(const CImg<t>& mask, const unsigned int method) const {
   return (+*this).inpaint(mask,method);
 }
 
+// When 'is_pyramid' is set, the image is first inpainted at half size (recursively), and the source
+// position found at the coarser scale for each target point is used as an additional lookup origin.
 template<typename t>
 CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
                        const unsigned int lookup_size=22, const float lookup_factor=1,
                        const int lookup_increment=1,
                        const unsigned int blend_size=0, const float blend_threshold=0.5f,
                        const float blend_decay=0.02f, const unsigned int blend_scales=10,
-                       const bool is_blend_outer=false) {
+                       const bool is_blend_outer=false, const bool is_pyramid=false) {
+  return _inpaint_patch(mask,patch_size,lookup_size,lookup_factor,lookup_increment,
+                        blend_size,blend_threshold,blend_decay,blend_scales,is_blend_outer,is_pyramid,0);
+}
+
+// If 'sources' is not null, it receives the source position of each inpainted point
+// (and '~0U' for other points).
+template<typename t>
+CImg<T>& _inpaint_patch(const CImg<t>& mask, const unsigned int patch_size,
+                        const unsigned int lookup_size, const float lookup_factor,
+                        const int lookup_increment,
+                        const unsigned int blend_size, const float blend_threshold,
+                        const float blend_decay, const unsigned int blend_scales,
+                        const bool is_blend_outer, const bool is_pyramid,
+                        CImg<unsigned int> *const sources) {
+  if (sources) sources->assign();
   if (depth()>1)
     throw CImgInstanceException(_cimg_instance
                                 "inpaint_patch(): Instance image is volumetric (should be 2D).",
@@ -1019,6 +2453,18 @@ CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
     if (y>(int)ym1) ym1 = (unsigned int)y;
   }
   if (!is_mask_found) return *this;
+
+  // Inpaint half-size image and mask first (pyramid mode), to get coarse source positions.
+  CImg<unsigned int> coarse_sources;
+  if (is_pyramid && std::min(_width,_height)>=4*patch_size) {
+    const unsigned int cw = _width/2, ch = _height/2;
+    CImg<ucharT> coarse_mask(cw,ch,1,1,0);
+    cimg_forXY(mask,x,y) if (mask(x,y) && x/2<(int)cw && y/2<(int)ch) coarse_mask(x/2,y/2) = 1;
+    get_resize(cw,ch,1,-100,2).
+      _inpaint_patch(coarse_mask,patch_size,std::max(1U,lookup_size/2),lookup_factor,lookup_increment,
+                     0,blend_threshold,blend_decay,blend_scales,false,true,&coarse_sources);
+  }
+
   xm0 = xm0>2?xm0 - 2:0;
   ym0 = ym0>2?ym0 - 2:0;
   xm1 = xm1<_width - 3?xm1 + 2:_width - 1;
@@ -1043,7 +2489,9 @@ CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
 
   CImg<floatT> confidences(nmask), priorities(dx,dy,1,2,-1), pC;
   CImg<unsigned int> saved_patches(4,256), is_visited(width(),height(),1,1,0);
-  CImg<ucharT> pM, pN;  // Pre-declare patch variables (avoid iterative memory alloc/dealloc)
+  CImg<int> lookup_positions(2,256), chunk_inds;
+  CImg<floatT> chunk_ssds;
+  CImg<ucharT> pM;  // Pre-declare patch variables (avoid iterative memory alloc/dealloc)
   CImg<T> pP, pbest;
   CImg<floatT> weights(patch_size,patch_size,1,1,0);
   weights.draw_gaussian((float)p1,(float)p1,patch_size/15.f,&one)/=patch_size2;
@@ -1147,6 +2595,20 @@ CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
         }
       }
     }
+    // Add the upscaled source position found at the coarser scale (pyramid mode).
+    if (!coarse_sources.is_empty()) {
+      const int
+        X = std::min(target_x/2,coarse_sources.width() - 1),
+        Y = std::min(target_y/2,coarse_sources.height() - 1);
+      if (coarse_sources(X,Y,0)!=~0U) {
+        *(ptr_lookup_candidates++) = std::min(2*coarse_sources(X,Y,0) + (target_x&1),_width - 1);
+        *(ptr_lookup_candidates++) = std::min(2*coarse_sources(X,Y,1) + (target_y&1),_height - 1);
+        if (++nb_lookup_candidates>=lookup_candidates._height) {
+          lookup_candidates.resize(2,-200,1,1,0);
+          ptr_lookup_candidates = lookup_candidates.data(0,nb_lookup_candidates);
+        }
+      }
+    }
     // Add also target point as a center for the patch lookup.
     if (++nb_lookup_candidates>=lookup_candidates._height) {
       lookup_candidates.resize(2,-200,1,1,0);
@@ -1191,8 +2653,10 @@ CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
     const unsigned int
       _lookup_increment = (unsigned int)(lookup_increment>0?lookup_increment:
                                          nb_lookup_candidates>1?1:-lookup_increment);
-    float best_ssd = cimg::type<float>::max();
-    int best_x = -1, best_y = -1;
+    // List lookup positions first (each position once, in lookup order), then compare patches in parallel
+    // by chunks of positions. The best patch of each chunk is kept with a strict comparison, and chunks
+    // are merged in order, so the selected patch is the same as with a sequential lookup.
+    unsigned int nb_positions = 0;
     for (unsigned int C = 0; C<nb_lookup_candidates; ++C) {
       const int
         xl = (int)lookup_candidates(0,C),
@@ -1201,28 +2665,56 @@ CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
         xl1 = std::min(width() - 1 - p2,xl + l2), yl1 = std::min(height() - 1 - p2,yl + l2);
       for (int y = yl0; y<=yl1; y+=_lookup_increment)
         for (int x = xl0; x<=xl1; x+=_lookup_increment) if (is_visited(x,y)!=target_index) {
-            if (is_strict_search) mask._inpaint_patch_crop(x - p1,y - p1,x + p2,y + p2,1).move_to(pN);
-            else nmask._inpaint_patch_crop(x - ox - p1,y - oy - p1,x - ox + p2,y - oy + p2,0).move_to(pN);
-            if ((is_strict_search && pN.sum()==0) || (!is_strict_search && pN.sum()==patch_size2)) {
-              _inpaint_patch_crop(x - p1,y - p1,x + p2,y + p2,0).move_to(pC);
-              float ssd = 0;
-              const T *_pP = pP._data;
-              const float *_pC = pC._data;
-              cimg_for(pM,_pM,unsigned char) { if (*_pM) {
-                  cimg_forC(pC,c) {
-                    ssd+=cimg::sqr((Tfloat)*_pC - (Tfloat)*_pP); _pC+=patch_size2; _pP+=patch_size2;
-                  }
-                  if (ssd>=best_ssd) break;
-                  _pC-=pC._spectrum*patch_size2;
-                  _pP-=pC._spectrum*patch_size2;
-                }
-                ++_pC; ++_pP;
+            is_visited(x,y) = target_index;
+            lookup_positions(0,nb_positions) = x;
+            lookup_positions(1,nb_positions) = y;
+            if (++nb_positions>=lookup_positions._height) lookup_positions.resize(2,-200,1,1,0);
+          }
+    }
+    const int chunk_size = 64, nb_chunks = ((int)nb_positions + chunk_size - 1)/chunk_size;
+    chunk_ssds.assign(std::max(nb_chunks,1));
+    chunk_inds.assign(std::max(nb_chunks,1));
+    cimg_pragma_openmp(parallel for schedule(dynamic,1)
+                       if (nb_chunks>1 && (ulongT)nb_positions*patch_size2*_spectrum>=65536))
+    for (int chunk = 0; chunk<nb_chunks; ++chunk) {
+      CImg<ucharT> pN;
+      CImg<floatT> pC;
+      float best_ssd = cimg::type<float>::max();
+      int best_ind = -1;
+      const int k1 = std::min((chunk + 1)*chunk_size,(int)nb_positions);
+      for (int k = chunk*chunk_size; k<k1; ++k) {
+        const int x = lookup_positions(0,k), y = lookup_positions(1,k);
+        if (is_strict_search) mask._inpaint_patch_crop(x - p1,y - p1,x + p2,y + p2,1).move_to(pN);
+        else nmask._inpaint_patch_crop(x - ox - p1,y - oy - p1,x - ox + p2,y - oy + p2,0).move_to(pN);
+        if ((is_strict_search && pN.sum()==0) || (!is_strict_search && pN.sum()==patch_size2)) {
+          _inpaint_patch_crop(x - p1,y - p1,x + p2,y + p2,0).move_to(pC);
+          float ssd = 0;
+          const T *_pP = pP._data;
+          const float *_pC = pC._data;
+          cimg_for(pM,_pM,unsigned char) { if (*_pM) {
+              cimg_forC(pC,c) {
+                ssd+=cimg::sqr((Tfloat)*_pC - (Tfloat)*_pP); _pC+=patch_size2; _pP+=patch_size2;
               }
-              if (ssd<best_ssd) { best_ssd = ssd; best_x = x; best_y = y; }
+              if (ssd>=best_ssd) break;
+              _pC-=pC._spectrum*patch_size2;
+              _pP-=pC._spectrum*patch_size2;
             }
-            is_visited(x,y) = target_index;
+            ++_pC; ++_pP;
           }
+          if (ssd<best_ssd) { best_ssd = ssd; best_ind = k; }
+        }
+      }
+      chunk_ssds[chunk] = best_ssd;
+      chunk_inds[chunk] = best_ind;
     }
+    float best_ssd = cimg::type<float>::max();
+    int best_x = -1, best_y = -1;
+    for (int chunk = 0; chunk<nb_chunks; ++chunk)
+      if (chunk_inds[chunk]>=0 && chunk_ssds[chunk]<best_ssd) {
+        best_ssd = chunk_ssds[chunk];
+        best_x = lookup_positions(0,chunk_inds[chunk]);
+        best_y = lookup_positions(1,chunk_inds[chunk]);
+      }
 
     if (best_x<0) { // If no best patch found
       priorities(target_x - ox,target_y - oy,0)/=10; // Reduce its priority (lower data_term)
@@ -1246,7 +2738,8 @@ CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
         move_to(pM);
       cimg_for(pM,ptr,unsigned char) *ptr = (unsigned char)(1 - *ptr);
       draw_image(target_x - p1,target_y - p1,pbest,pM,1,1);
-      confidences.draw_image(target_x - ox - p1,target_y - oy - p1,pC.fill(target_confidence),pM,1,1);
+      confidences.draw_image(target_x - ox - p1,target_y - oy - p1,
+                             pC.assign(patch_size,patch_size,1,1,target_confidence),pM,1,1);
       nmask.draw_rectangle(target_x - ox - p1,target_y - oy - p1,0,0,target_x - ox + p2,target_y - oy + p2,0,0,1);
       priorities.draw_rectangle(target_x - ox - (int)patch_size,
                                 target_y - oy - (int)patch_size,0,0,
@@ -1265,6 +2758,24 @@ CImg<T>& inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
   priorities.assign();
   confidences.assign();
   is_visited.assign();
+  coarse_sources.assign();
+
+  // Return source positions of inpainted points (if requested).
+  if (sources) {
+    sources->assign(_width,_height,1,2,~0U);
+    for (int l = (int)nb_saved_patches - 1; l>=0; --l) { // First patch drawn on a point is its source
+      const unsigned int *ptr = saved_patches.data(0,l);
+      const int xs = (int)ptr[0], ys = (int)ptr[1], xd = (int)ptr[2], yd = (int)ptr[3];
+      for (int q = -p1; q<=p2; ++q)
+        for (int p = -p1; p<=p2; ++p) {
+          const int xdp = xd + p, ydq = yd + q;
+          if (xdp>=0 && xdp<width() && ydq>=0 && ydq<height() && mask(xdp,ydq)) {
+            (*sources)(xdp,ydq,0) = (unsigned int)(xs + p);
+            (*sources)(xdp,ydq,1) = (unsigned int)(ys + q);
+          }
+        }
+    }
+  }
 
   // Blend inpainting result (if requested), using multi-scale blending algorithm.
   if (blend_size && blend_scales) {
@@ -1410,9 +2921,9 @@ CImg<T> get_inpaint_patch(const CImg<t>& mask, const unsigned int patch_size=11,
                           const int lookup_increment=1,
                           const unsigned int blend_size=0, const float blend_threshold=0.5,
                           const float blend_decay=0.02f, const unsigned int blend_scales=10,
-                          const bool is_blend_outer=false) const {
+                          const bool is_blend_outer=false, const bool is_pyramid=false) const {
   return (+*this).inpaint_patch(mask,patch_size,lookup_size,lookup_factor,lookup_increment,
-                                blend_size,blend_threshold,blend_decay,blend_scales,is_blend_outer);
+                                blend_size,blend_threshold,blend_decay,blend_scales,is_blend_outer,is_pyramid);
 }
 
 CImg<T>& max(const char *const expression, CImgList<T> &images) {
@@ -1743,6 +3254,17 @@ CImg<T> get_shift_CImg3d(const float tx, const float ty, const float tz) const {
   return (+*this).shift_CImg3d(tx,ty,tz);
 }
 
+// Return values [ptr0,ptr1) of a CImg3d as a column vector (used by 'get_split_CImg3d()').
+CImg<T> _gmic_CImg3d_part(const T *const ptr0, const T *const ptr1) const {
+  const ulongT siz = (ulongT)(ptr1 - ptr0);
+  if (siz>~0U)
+    throw CImgInstanceException(_cimg_instance
+                                "get_split_CImg3d(): Part of CImg3d has %lu values, too many to be stored "
+                                "as a single column.",
+                                cimg_instance,(unsigned long)siz);
+  return CImg<T>(ptr0,1,(unsigned int)siz,1,1);
+}
+
 CImgList<T> get_split_CImg3d() const {
   CImg<charT> error_message(1024);
   if (!is_CImg3d(false,error_message))
@@ -1751,17 +3273,17 @@ CImgList<T> get_split_CImg3d() const {
                                 cimg_instance,error_message.data());
   CImgList<T> res;
   const T *ptr0 = _data, *ptr = ptr0 + 6;
-  CImg<T>(ptr0,1,(unsigned int)(ptr - ptr0),1,1).move_to(res); // Header
+  _gmic_CImg3d_part(ptr0,ptr).move_to(res); // Header
   ptr0 = ptr;
   const unsigned int
     nbv = cimg::float2uint(*(ptr++)),
     nbp = cimg::float2uint(*(ptr++));
-  CImg<T>(ptr0,1,(unsigned int)(ptr - ptr0),1,1).move_to(res); // Nb vertices and primitives
-  ptr0 = ptr; ptr+=3*nbv;
-  CImg<T>(ptr0,1,(unsigned int)(ptr - ptr0),1,1).move_to(res); // Vertices
+  _gmic_CImg3d_part(ptr0,ptr).move_to(res); // Nb vertices and primitives
+  ptr0 = ptr; ptr+=3*(ulongT)nbv;
+  _gmic_CImg3d_part(ptr0,ptr).move_to(res); // Vertices
   ptr0 = ptr;
   for (unsigned int i = 0; i<nbp; ++i) ptr+=(unsigned int)(*ptr) + 1;
-  CImg<T>(ptr0,1,(unsigned int)(ptr - ptr0),1,1).move_to(res); // Primitives
+  _gmic_CImg3d_part(ptr0,ptr).move_to(res); // Primitives
   ptr0 = ptr;
   for (unsigned int i = 0; i<nbp; ++i) {
     const T val = *(ptr++);
@@ -1772,10 +3294,10 @@ CImgList<T> get_split_CImg3d() const {
         h = cimg::float2uint(ptr[1]),
         s = cimg::float2uint(ptr[2]);
       ptr+=3;
-      if (w*h*s!=0) ptr+=w*h*s;
+      ptr+=(ulongT)w*h*s;
     }
   }
-  CImg<T>(ptr0,1,(unsigned int)(ptr - ptr0),1,1).move_to(res); // Colors/Textures
+  _gmic_CImg3d_part(ptr0,ptr).move_to(res); // Colors/Textures
   ptr0 = ptr;
   for (unsigned int i = 0; i<nbp; ++i) {
     const T val = *(ptr++);
@@ -1785,22 +3307,364 @@ CImgList<T> get_split_CImg3d() const {
         h = cimg::float2uint(ptr[1]),
         s = cimg::float2uint(ptr[2]);
       ptr+=3;
-      if (w*h*s!=0) ptr+=w*h*s;
+      ptr+=(ulongT)w*h*s;
     }
   }
-  CImg<T>(ptr0,1,(unsigned int)(ptr - ptr0),1,1).move_to(res); // Opacities
+  _gmic_CImg3d_part(ptr0,ptr).move_to(res); // Opacities
   return res;
 }
 
 static const CImgList<T>& save_gmz(const char *filename, const CImgList<T>& images, const CImgList<charT>& names) {
-  CImgList<T> gmz(images.size() + 1);
-  cimglist_for(images,l) gmz[l].assign(images[l],true);
-  CImg<charT> gmz_info = CImg<charT>::string("GMZ");
-  gmz_info.append((names>'x'),'x').unroll('y').move_to(gmz.back());
-  gmz.save_cimg(filename,true);
+  save_gmic_cimg(filename,images,&names,true);
   return images;
 }
 
+// Save images (and their names, for .gmz files) as a .cimg[z] file.
+// Compressed images are deflated by blocks in parallel (see 'gmic_compress()').
+static void save_gmic_cimg(const char *const filename, const CImgList<T>& images,
+                           const CImgList<charT> *const names, const bool is_compressed) {
+  std::FILE *const file = cimg::fopen(filename,"wb");
+  std::fputs(gmic_cimg_header(images.size() + (names?1:0)),file);
+  cimglist_for(images,l) gmic_write_cimg_frame(file,images[l],is_compressed);
+  if (names) {
+    CImg<charT> gmz_info = CImg<charT>::string("GMZ");
+    gmz_info.append((*names>'x'),'x').unroll('y');
+    gmic_write_cimg_frame(file,CImg<T>(gmz_info),is_compressed);
+  }
+  cimg::fclose(file);
+}
+
+#ifdef cimg_use_zlib
+static void _gmic_put_uint64(unsigned char *const ptr, const cimg_uint64 val) {
+  for (unsigned int k = 0; k<8; ++k) ptr[k] = (unsigned char)(val>>(8*k));
+}
+
+static cimg_uint64 _gmic_get_uint64(const unsigned char *const ptr) {
+  cimg_uint64 val = 0;
+  for (unsigned int k = 0; k<8; ++k) val|=(cimg_uint64)ptr[k]<<(8*k);
+  return val;
+}
+
+// Compress a buffer as a zlib stream, made of blocks that are deflated independently and in parallel.
+// The result is a regular zlib stream, followed by an index of the block offsets (ignored by 'uncompress()'),
+// so that 'gmic_uncompress()' can also inflate blocks in parallel.
+// Return 'false' if compression failed, or if the compressed size does not fit in an image.
+static bool gmic_compress(const unsigned char *const buf, const cimg_ulong siz, CImg<unsigned char>& res) {
+  const cimg_ulong bsiz = (cimg_ulong)1<<20;
+  const unsigned int nb_blocks = (unsigned int)((siz + bsiz - 1)/bsiz);
+  if (nb_blocks<2) { // Small buffer: single zlib stream
+    uLongf csiz = compressBound((uLong)siz);
+    if ((cimg_ulong)csiz>~0U) return false;
+    res.assign((unsigned int)csiz);
+    if (compress(res._data,&csiz,buf,(uLong)siz)!=Z_OK) return false;
+    res.assign(res._data,(unsigned int)csiz);
+    return true;
+  }
+
+  CImgList<unsigned char> blocks(nb_blocks);
+  CImg<cimg_uint64> adlers(nb_blocks);
+  unsigned int nb_errors = 0;
+  cimg_pragma_openmp(parallel for schedule(dynamic,1))
+  for (int k = 0; k<(int)nb_blocks; ++k) {
+    const cimg_ulong off = k*bsiz, bs = std::min(bsiz,siz - off);
+    const bool is_last = k==(int)nb_blocks - 1;
+    CImg<unsigned char> &block = blocks[k];
+    z_stream zs;
+    std::memset(&zs,0,sizeof(zs));
+    adlers[k] = (cimg_uint64)adler32(adler32(0L,Z_NULL,0),buf + off,(uInt)bs);
+    if (deflateInit2(&zs,Z_DEFAULT_COMPRESSION,Z_DEFLATED,-15,8,Z_DEFAULT_STRATEGY)!=Z_OK) {
+      cimg_pragma_openmp(atomic) ++nb_errors;
+      continue;
+    }
+    block.assign((unsigned int)deflateBound(&zs,(uLong)bs) + 16);
+    zs.next_in = (Bytef*)(buf + off);
+    zs.avail_in = (uInt)bs;
+    zs.next_out = block._data;
+    zs.avail_out = (uInt)block._width;
+    const int err = deflate(&zs,is_last?Z_FINISH:Z_SYNC_FLUSH); // Sync flush: blocks end on a byte boundary
+    if ((is_last && err!=Z_STREAM_END) || (!is_last && (err!=Z_OK || zs.avail_in))) {
+      cimg_pragma_openmp(atomic) ++nb_errors;
+    } else block.assign(block._data,(unsigned int)zs.total_out);
+    deflateEnd(&zs);
+  }
+  if (nb_errors) return false;
+
+  // Assemble zlib stream (header + blocks + adler32), then block index.
+  uLong adler = (uLong)adlers[0];
+  cimg_ulong csiz = 2 + 4;
+  cimglist_for(blocks,k) {
+    if (k) adler = adler32_combine(adler,(uLong)adlers[k],(z_off_t)std::min(bsiz,siz - k*bsiz));
+    csiz+=blocks[k].size();
+  }
+  const cimg_ulong tsiz = csiz + 8*((cimg_ulong)nb_blocks + 2) + 4;
+  if (tsiz>~0U) return false; // Too large to be stored as an image: caller stores data uncompressed
+  res.assign((unsigned int)tsiz);
+  unsigned char *ptrd = res._data, *ptri = res._data + csiz;
+  *(ptrd++) = 0x78; *(ptrd++) = 0x9C;
+  cimglist_for(blocks,k) {
+    _gmic_put_uint64(ptri,(cimg_uint64)(ptrd - res._data)); ptri+=8;
+    std::memcpy(ptrd,blocks[k]._data,blocks[k].size());
+    ptrd+=blocks[k].size();
+  }
+  for (int k = 3; k>=0; --k) *(ptrd++) = (unsigned char)(adler>>(8*k));
+  _gmic_put_uint64(ptri,(cimg_uint64)bsiz); ptri+=8;
+  _gmic_put_uint64(ptri,(cimg_uint64)nb_blocks); ptri+=8;
+  std::memcpy(ptri,"GMZI",4);
+  return true;
+}
+
+// Uncompress a zlib stream (in parallel if it has been generated by 'gmic_compress()').
+static bool gmic_uncompress(const unsigned char *const cbuf, const cimg_ulong csiz,
+                            unsigned char *const buf, const cimg_ulong siz) {
+  if (csiz>=2 + 4 + 8*3 + 4 && !std::memcmp(cbuf + csiz - 4,"GMZI",4)) {
+    const cimg_uint64
+      nb_blocks = _gmic_get_uint64(cbuf + csiz - 12),
+      bsiz = _gmic_get_uint64(cbuf + csiz - 20),
+      isiz = 8*(nb_blocks + 2) + 4;
+    if (nb_blocks && bsiz && isiz + 6<=csiz && (nb_blocks - 1)*bsiz<siz && nb_blocks*bsiz>=siz) {
+      const unsigned char *const index = cbuf + csiz - isiz;
+      const cimg_uint64 stream_end = csiz - isiz - 4; // Skip adler32 checksum
+      CImg<cimg_uint64> adlers((unsigned int)nb_blocks);
+      unsigned int nb_errors = 0;
+      cimg_pragma_openmp(parallel for schedule(dynamic,1) if (nb_blocks>1))
+      for (int k = 0; k<(int)nb_blocks; ++k) {
+        const cimg_uint64
+          off0 = _gmic_get_uint64(index + 8*k),
+          off1 = k<(int)nb_blocks - 1?_gmic_get_uint64(index + 8*(k + 1)):stream_end,
+          boff = k*bsiz, bs = std::min(bsiz,(cimg_uint64)siz - boff);
+        z_stream zs;
+        std::memset(&zs,0,sizeof(zs));
+        if (off0<2 || off0>=off1 || off1>stream_end || inflateInit2(&zs,-15)!=Z_OK) {
+          cimg_pragma_openmp(atomic) ++nb_errors;
+          continue;
+        }
+        zs.next_in = (Bytef*)(cbuf + off0);
+        zs.avail_in = (uInt)(off1 - off0);
+        zs.next_out = buf + boff;
+        zs.avail_out = (uInt)bs;
+        const int err = inflate(&zs,Z_SYNC_FLUSH);
+        if (zs.total_out!=bs || (err!=Z_OK && err!=Z_STREAM_END && err!=Z_BUF_ERROR)) {
+          cimg_pragma_openmp(atomic) ++nb_errors;
+        } else adlers[k] = (cimg_uint64)adler32(adler32(0L,Z_NULL,0),buf + boff,(uInt)bs);
+        inflateEnd(&zs);
+      }
+      if (!nb_errors) { // Check adler32 checksum of the whole stream
+        uLong adler = (uLong)adlers[0];
+        for (unsigned int k = 1; k<(unsigned int)nb_blocks; ++k)
+          adler = adler32_combine(adler,(uLong)adlers[k],(z_off_t)std::min(bsiz,(cimg_uint64)siz - k*bsiz));
+        const unsigned char *const ptr = cbuf + stream_end;
+        const uLong stored_adler = ((uLong)ptr[0]<<24) | ((uLong)ptr[1]<<16) | ((uLong)ptr[2]<<8) | ptr[3];
+        return (adler&0xFFFFFFFFUL)==stored_adler;
+      }
+    }
+  }
+  uLongf dsiz = (uLongf)siz;
+  return uncompress(buf,&dsiz,cbuf,(uLong)csiz)==Z_OK && (cimg_ulong)dsiz==siz;
+}
+#endif // #ifdef cimg_use_zlib
+
+// Return G'MIC name (and size in bytes) of a pixel type, as written in a .cimg file header (0 if unknown).
+static const char *gmic_cimg_pixel_type(const char *const str, unsigned int *const size=0) {
+  static const char *const aliases[] = {
+    "bool","uchar", "uint8","uchar", "unsigned_char","uchar", "unsigned char","uchar", "uchar","uchar",
+    "int8","char", "char","char", "signed_char","char", "signed char","char",
+    "uint16","ushort", "unsigned_short","ushort", "unsigned short","ushort", "ushort","ushort",
+    "int16","short", "short","short",
+    "uint32","uint", "unsigned_int","uint", "unsigned int","uint", "uint","uint",
+    "int32","int", "int","int",
+    "uint64","uint64", "unsigned_int64","uint64", "unsigned int64","uint64", "int64","int64",
+    "float32","float", "float","float",
+    "float64","double", "double","double" };
+  static const unsigned int sizes[] = {
+    1,1,1,1,1, 1,1,1,1, 2,2,2,2, 2,2, 4,4,4,4, 4,4, 8,8,8,8, 4,4, 8,8 };
+  if (str) for (unsigned int k = 0; k<sizeof(sizes)/sizeof(unsigned int); ++k)
+    if (!cimg::strcasecmp(str,aliases[2*k])) { if (size) *size = sizes[k]; return aliases[2*k + 1]; }
+  return 0;
+}
+
+// Generate header line of a .cimg[z] or .gmz file (number of images written with at least 'count_width' digits).
+static CImg<charT> gmic_cimg_header(const unsigned int N, const unsigned int count_width=0) {
+  const char *const ptype = pixel_type(), *const etype = cimg::endianness()?"big":"little";
+  CImg<charT> res(128);
+  if (std::strstr(ptype,"unsigned")==ptype)
+    cimg_snprintf(res,res._width,"%0*u unsigned_%s %s_endian\n",(int)count_width,N,ptype + 9,etype);
+  else cimg_snprintf(res,res._width,"%0*u %s %s_endian\n",(int)count_width,N,ptype,etype);
+  return res;
+}
+
+// Read header of a .cimg[z] or .gmz file.
+// Return the number of digits used to store the number of images (0 if invalid header).
+static unsigned int gmic_read_cimg_header(std::FILE *const file, unsigned int &N,
+                                          const char* &stype, unsigned int &type_size, bool &is_big_endian) {
+  CImg<charT> line(256), str_type(256,1,1,1,0), str_endian(256,1,1,1,0);
+  int i, j = 0;
+  while ((i=std::fgetc(file))!='\n' && i!=EOF && j<255) line[j++] = (char)i;
+  line[j] = 0;
+  if (i!='\n' ||
+      cimg_sscanf(line,"%u%*c%255[A-Za-z0-9_]%*c%255[sA-Za-z_ ]",&N,str_type._data,str_endian._data)<2 ||
+      !(stype = gmic_cimg_pixel_type(str_type,&type_size))) return 0;
+  is_big_endian = !cimg::strncasecmp(str_endian,"big",3);
+  return (unsigned int)std::strspn(line,"0123456789");
+}
+
+// Read header of an image stored in a .cimg[z] or .gmz file.
+static bool gmic_read_cimg_frame_header(std::FILE *const file,
+                                        unsigned int &W, unsigned int &H, unsigned int &D, unsigned int &C,
+                                        cimg_uint64 &csiz) {
+  CImg<charT> line(256);
+  int i, j = 0;
+  while ((i=std::fgetc(file))!='\n' && i!=EOF && j<255) line[j++] = (char)i;
+  line[j] = 0;
+  W = H = D = C = 0; csiz = 0;
+  return i=='\n' && cimg_sscanf(line,"%u %u %u %u #" cimg_fuint64,&W,&H,&D,&C,&csiz)>=4;
+}
+
+// Write an image in a .cimg[z] or .gmz file (possibly compressed).
+static void gmic_write_cimg_frame(std::FILE *const file, const CImg<T>& img, const bool is_compressed) {
+  std::fprintf(file,"%u %u %u %u",img._width,img._height,img._depth,img._spectrum);
+  if (!img._data) { std::fputc('\n',file); return; }
+#ifdef cimg_use_zlib
+  CImg<unsigned char> cbuf;
+  if (is_compressed && gmic_compress((unsigned char*)img._data,sizeof(T)*img.size(),cbuf)) {
+    std::fprintf(file," #%lu\n",(unsigned long)cbuf.size());
+    cimg::fwrite(cbuf._data,cbuf.size(),file);
+    return;
+  }
+#else // #ifdef cimg_use_zlib
+  cimg::unused(is_compressed);
+#endif // #ifdef cimg_use_zlib
+  std::fputc('\n',file);
+  cimg::fwrite(img._data,img.size(),file);
+}
+
+// Return G'MIC name of the pixel type used in an existing .cimg[z] or .gmz file (0 if file does not exist).
+static const char *gmic_cimg_file_pixel_type(const char *const filename) {
+  std::FILE *const file = cimg::std_fopen(filename,"rb");
+  if (!file) return 0;
+  unsigned int N = 0, type_size = 0;
+  const char *stype = 0;
+  bool is_big_endian = false;
+  if (!gmic_read_cimg_header(file,N,stype,type_size,is_big_endian)) stype = 0;
+  cimg::fclose(file);
+  return stype;
+}
+
+// Append images (and their names, for .gmz files) to a .cimg[z] or .gmz file, without rewriting its content.
+// The file is created if it does not exist. The number of images is stored with a fixed width in the header,
+// so that it can be updated in place. For .gmz files, the trailing image of names is rewritten.
+static void save_cimg_append(const char *const filename, const CImgList<T>& images,
+                             const CImgList<charT> *const names, const bool is_compressed) {
+  if (!filename)
+    throw CImgArgumentException("CImg<%s>::save_cimg_append(): Specified filename is (null).",
+                                pixel_type());
+  const char *const stype = gmic_cimg_pixel_type(pixel_type());
+  CImgList<charT> all_names;
+  unsigned int N = 0, count_width = 10;
+  std::FILE *file = cimg::std_fopen(filename,"r+b");
+
+  if (file) { // Existing file: check header and go to end of last image
+    const char *file_stype = 0;
+    unsigned int type_size = 0;
+    bool is_big_endian = false;
+    if (!(count_width = gmic_read_cimg_header(file,N,file_stype,type_size,is_big_endian))) {
+      cimg::fclose(file);
+      throw CImgIOException("CImg<%s>::save_cimg_append(): File '%s' is not a valid .cimg file.",
+                            pixel_type(),filename);
+    }
+    if (is_big_endian!=cimg::endianness() || std::strcmp(stype,file_stype)) {
+      cimg::fclose(file);
+      throw CImgIOException("CImg<%s>::save_cimg_append(): Cannot append to file '%s' "
+                            "(stored with pixel type '%s' and %s endianness).",
+                            pixel_type(),filename,file_stype,is_big_endian?"big":"little");
+    }
+    const cimg_long header_size = cimg::ftell(file);
+    cimg_long offset = header_size, offset_last = header_size;
+    unsigned int W, H, D, C;
+    cimg_uint64 csiz;
+    for (unsigned int l = 0; l<N; ++l) {
+      offset_last = offset;
+      if (!gmic_read_cimg_frame_header(file,W,H,D,C,csiz)) {
+        cimg::fclose(file);
+        throw CImgIOException("CImg<%s>::save_cimg_append(): Invalid header for image #%u in file '%s'.",
+                              pixel_type(),l,filename);
+      }
+      offset = cimg::ftell(file) + (cimg_long)(csiz?csiz:(cimg_uint64)W*H*D*C*sizeof(T));
+      cimg::fseek(file,offset,SEEK_SET);
+    }
+
+    if (names) { // Retrieve names from last image, which is then overwritten
+      CImgList<T> back;
+      if (N) {
+        cimg::fclose(file);
+        back.load_cimg_frames(filename,N - 1,N - 1);
+        file = cimg::fopen(filename,"r+b");
+      }
+      const CImg<charT> info = back?CImg<charT>(back[0]):CImg<charT>::empty();
+      if (info.width()!=1 || info.depth()!=1 || info.spectrum()!=1 || info.height()<4 ||
+          info[0]!='G' || info[1]!='M' || info[2]!='Z' || info[3]) {
+        cimg::fclose(file);
+        throw CImgIOException("CImg<%s>::save_cimg_append(): File '%s' is not in .gmz format "
+                              "(magic number not found).",
+                              pixel_type(),filename);
+      }
+      info.get_split(CImg<charT>::vector(0),0,false).move_to(all_names);
+      all_names.remove(0);
+      cimglist_for(all_names,l) all_names[l].resize(1,all_names[l].height() + 1,1,1,0).unroll('x');
+      offset = offset_last;
+      --N;
+    }
+
+    unsigned int nb_digits = 1;
+    for (unsigned int n = N + images.size() + (names?1:0); n>=10; n/=10) ++nb_digits;
+    if (nb_digits>count_width) {
+      // Stored number of images has not enough digits: write a wider header, once.
+      // Existing images are moved forward in place, by chunks (starting from the end).
+      count_width = 10;
+      const CImg<charT> header = gmic_cimg_header(N,count_width);
+      const cimg_long shift = (cimg_long)std::strlen(header) - header_size;
+      CImg<unsigned char> chunk(4U<<20);
+      for (cimg_long pos = offset; pos>header_size; ) {
+        const cimg_long len = std::min((cimg_long)chunk._width,pos - header_size);
+        pos-=len;
+        cimg::fseek(file,pos,SEEK_SET);
+        cimg::fread(chunk._data,(size_t)len,file);
+        cimg::fseek(file,pos + shift,SEEK_SET);
+        cimg::fwrite(chunk._data,(size_t)len,file);
+      }
+      cimg::fseek(file,0,SEEK_SET);
+      std::fputs(header,file);
+      offset+=shift;
+    }
+    cimg::fseek(file,offset,SEEK_SET);
+  } else { // New file
+    file = cimg::fopen(filename,"w+b");
+    std::fputs(gmic_cimg_header(N,count_width),file);
+  }
+
+  // Append new images (and names).
+  cimglist_for(images,l) gmic_write_cimg_frame(file,images[l],is_compressed);
+  N+=images.size();
+  if (names) {
+    cimglist_for(*names,l) CImg<charT>((*names)[l]).move_to(all_names);
+    CImg<charT> gmz_info = CImg<charT>::string("GMZ");
+    gmz_info.append((all_names>'x'),'x').unroll('y');
+    gmic_write_cimg_frame(file,CImg<T>(gmz_info),is_compressed);
+    ++N;
+  }
+
+  // Discard possible remaining data, then update number of images in header.
+  std::fflush(file);
+  const cimg_long siz = cimg::ftell(file);
+#if cimg_OS==1
+  if (ftruncate(fileno(file),(off_t)siz)) {}
+#elif cimg_OS==2
+  _chsize_s(_fileno(file),(__int64)siz);
+#endif // #if cimg_OS==1
+  cimg::fseek(file,0,SEEK_SET);
+  std::fprintf(file,"%0*u",(int)count_width,N);
+  cimg::fclose(file);
+}
+
 //--------------- End of CImg<T> plug-in ----------------------------
 
 // Add G'MIC-specific methods to the CImgList<T> class of the CImg library.
@@ -1820,6 +3684,345 @@ static CImg<T> rounded_copy(const CImg<T>& list) {
   return CImgList<T>(list,true);
 }
 
+// Load a range of images from a .cimg[z] or .gmz file, reading only the required data
+// (other images are skipped, even when compressed). If 'names' is specified, image names are
+// read from the trailing image of a .gmz file.
+// Image data is read either from 'file' or from memory buffer 'data' (if not null).
+template<typename t>
+static CImg<T> _load_cimg_frame(std::FILE *const file, const unsigned char *const data, const char *const filename,
+                                const unsigned int W, const unsigned int H,
+                                const unsigned int D, const unsigned int C,
+                                const cimg_uint64 csiz, const bool is_swap) {
+  CImg<t> raw(W,H,D,C);
+  if (!raw) return CImg<T>();
+  if (csiz) {
+#ifdef cimg_use_zlib
+    unsigned char *const cbuf = data?0:new unsigned char[(size_t)csiz];
+    if (cbuf) cimg::fread(cbuf,(size_t)csiz,file);
+    const bool is_uncompressed = CImg<T>::gmic_uncompress(data?data:cbuf,(cimg_ulong)csiz,
+                                                          (unsigned char*)raw._data,raw.size()*sizeof(t));
+    delete[] cbuf;
+    if (!is_uncompressed)
+      throw CImgIOException("CImgList<%s>::load_cimg_frames(): Failed to decompress data from '%s'.",
+                            pixel_type(),filename);
+#else // #ifdef cimg_use_zlib
+    throw CImgIOException("CImgList<%s>::load_cimg_frames(): Unable to read compressed data from '%s' "
+                          "unless zlib is enabled.",
+                          pixel_type(),filename);
+#endif // #ifdef cimg_use_zlib
+  } else if (data) std::memcpy((void*)raw._data,(const void*)data,raw.size()*sizeof(t));
+  else cimg::fread(raw._data,raw.size(),file);
+  if (is_swap) cimg::invert_endianness(raw._data,raw.size());
+  return CImg<T>(raw);
+}
+
+CImgList<T>& load_cimg_frames(const char *const filename,
+                              const unsigned int n0, const unsigned int n1,
+                              CImgList<charT> *const names=0) {
+  const unsigned int nn0 = std::min(n0,n1), nn1 = std::max(n0,n1);
+  std::FILE *const file = cimg::fopen(filename,"rb");
+  unsigned int N = 0, type_size = 0;
+  const char *stype = 0;
+  bool is_big_endian = false;
+  if (!CImg<T>::gmic_read_cimg_header(file,N,stype,type_size,is_big_endian)) {
+    cimg::fclose(file);
+    if (!nn0 && nn1==~0U && !names) return load_cimg(filename);
+    throw CImgIOException(_cimglist_instance
+                          "load_cimg_frames(): File '%s' is not a valid .cimg file.",
+                          cimglist_instance,filename);
+  }
+  const bool is_swap = is_big_endian!=cimg::endianness();
+  CImgList<charT> all_names;
+  assign();
+
+  unsigned int W, H, D, C;
+  cimg_uint64 csiz;
+  for (unsigned int l = 0; l<N; ++l) {
+    const bool is_last = l==N - 1;
+    if (!names && l>nn1) break;
+    if (!CImg<T>::gmic_read_cimg_frame_header(file,W,H,D,C,csiz)) {
+      cimg::fclose(file);
+      throw CImgIOException(_cimglist_instance
+                            "load_cimg_frames(): Invalid header for image #%u in file '%s'.",
+                            cimglist_instance,l,filename);
+    }
+    if ((l>=nn0 && l<=nn1) || (names && is_last)) {
+      CImg<T> img;
+
+#define _gmic_load_cimg_frame(value_type,svalue_type) \
+      if (!std::strcmp(stype,svalue_type)) \
+        img = _load_cimg_frame<value_type>(file,0,filename,W,H,D,C,csiz,is_swap);
+
+      _gmic_load_cimg_frame(unsigned char,"uchar")
+      else _gmic_load_cimg_frame(char,"char")
+        else _gmic_load_cimg_frame(unsigned short,"ushort")
+          else _gmic_load_cimg_frame(short,"short")
+            else _gmic_load_cimg_frame(unsigned int,"uint")
+              else _gmic_load_cimg_frame(int,"int")
+                else _gmic_load_cimg_frame(cimg_uint64,"uint64")
+                  else _gmic_load_cimg_frame(cimg_int64,"int64")
+                    else _gmic_load_cimg_frame(float,"float")
+                      else _gmic_load_cimg_frame(double,"double");
+
+      if (names && is_last && img.width()==1 && img.depth()==1 && img.spectrum()==1 && img.height()>=4 &&
+          img[0]=='G' && img[1]=='M' && img[2]=='Z' && !img[3]) {
+        CImg<charT>(img).get_split(CImg<charT>::vector(0),0,false).move_to(all_names);
+        all_names.remove(0);
+        cimglist_for(all_names,k) all_names[k].resize(1,all_names[k].height() + 1,1,1,0).unroll('x');
+      } else if (l>=nn0 && l<=nn1) img.move_to(*this);
+    } else if (!is_last)
+      cimg::fseek(file,(cimg_long)(csiz?csiz:(cimg_uint64)W*H*D*C*type_size),SEEK_CUR);
+  }
+  cimg::fclose(file);
+
+  if (names) {
+    names->assign();
+    for (unsigned int l = nn0; l<=nn1 && l<all_names.size(); ++l) all_names[l].move_to(*names);
+  }
+  return *this;
+}
+
+// Serialize list as a .cimg[z] buffer (same format as 'get_serialize()'),
+// where compressed images are deflated by blocks, in parallel.
+CImg<unsigned char> get_gmic_serialize(const bool is_compressed) const {
+#ifdef cimg_use_zlib
+  if (!is_compressed) return get_serialize(false);
+  CImgList<unsigned char> stream;
+  CImg<charT> tmp(128);
+  CImg<unsigned char>::string(CImg<T>::gmic_cimg_header(_width),false).move_to(stream);
+  cimglist_for(*this,l) {
+    const CImg<T>& img = _data[l];
+    cimg_snprintf(tmp,tmp._width,"%u %u %u %u",img._width,img._height,img._depth,img._spectrum);
+    CImg<unsigned char>::string(tmp,false).move_to(stream);
+    CImg<unsigned char> cbuf;
+    if (!img._data) CImg<unsigned char>::string("\n",false).move_to(stream);
+    else if (CImg<T>::gmic_compress((unsigned char*)img._data,sizeof(T)*img.size(),cbuf)) {
+      cimg_snprintf(tmp,tmp._width," #%lu\n",(unsigned long)cbuf.size());
+      CImg<unsigned char>::string(tmp,false).move_to(stream);
+      cbuf.move_to(stream);
+    } else {
+      CImg<unsigned char>::string("\n",false).move_to(stream);
+      stream.insert(CImg<unsigned char>((unsigned char*)img._data,(unsigned int)(sizeof(T)*img.size()),1,1,1,true));
+    }
+  }
+  cimglist_apply(stream,unroll)('y');
+  return stream>'y';
+#else // #ifdef cimg_use_zlib
+  return get_serialize(is_compressed);
+#endif // #ifdef cimg_use_zlib
+}
+
+// Unserialize a .cimg[z] buffer, inflating blocks of images in parallel when possible
+// (falls back to 'get_unserialize()' for buffers it does not recognize).
+template<typename t>
+static CImgList<T> get_gmic_unserialize(const CImg<t>& buffer) {
+#ifdef cimg_use_zlib
+  const CImg<unsigned char> ubuffer(buffer);
+  const unsigned char *ptr = ubuffer._data, *const eptr = ubuffer.end();
+  CImg<charT> line(256), str_type(256,1,1,1,0), str_endian(256,1,1,1,0);
+  unsigned int N = 0, type_size = 0, W, H, D, C, j = 0;
+  cimg_uint64 csiz;
+  const char *stype = 0;
+  while (ptr<eptr && *ptr!='\n' && j<255) line[j++] = (char)*(ptr++);
+  line[j] = 0;
+  if (ptr>=eptr || *(ptr++)!='\n' ||
+      cimg_sscanf(line,"%u%*c%255[A-Za-z0-9_]%*c%255[sA-Za-z_ ]",&N,str_type._data,str_endian._data)<2 ||
+      !(stype = CImg<T>::gmic_cimg_pixel_type(str_type,&type_size)))
+    return get_unserialize(buffer);
+  const bool is_big_endian = !cimg::strncasecmp(str_endian,"big",3), is_swap = is_big_endian!=cimg::endianness();
+
+  CImgList<T> res(N);
+  for (unsigned int l = 0; l<N; ++l) {
+    j = 0;
+    while (ptr<eptr && *ptr!='\n' && j<255) line[j++] = (char)*(ptr++);
+    line[j] = 0;
+    W = H = D = C = 0; csiz = 0;
+    if (ptr>=eptr || *(ptr++)!='\n' || cimg_sscanf(line,"%u %u %u %u #" cimg_fuint64,&W,&H,&D,&C,&csiz)<4)
+      return get_unserialize(buffer);
+    const cimg_uint64 siz = csiz?csiz:(cimg_uint64)W*H*D*C*type_size;
+    if ((cimg_uint64)(eptr - ptr)<siz) return get_unserialize(buffer);
+
+#define _gmic_unserialize_frame(value_type,svalue_type) \
+    if (!std::strcmp(stype,svalue_type)) \
+      _load_cimg_frame<value_type>(0,ptr,"(buffer)",W,H,D,C,csiz,is_swap).move_to(res[l]);
+
+    _gmic_unserialize_frame(unsigned char,"uchar")
+    else _gmic_unserialize_frame(char,"char")
+      else _gmic_unserialize_frame(unsigned short,"ushort")
+        else _gmic_unserialize_frame(short,"short")
+          else _gmic_unserialize_frame(unsigned int,"uint")
+            else _gmic_unserialize_frame(int,"int")
+              else _gmic_unserialize_frame(cimg_uint64,"uint64")
+                else _gmic_unserialize_frame(cimg_int64,"int64")
+                  else _gmic_unserialize_frame(float,"float")
+                    else _gmic_unserialize_frame(double,"double");
+    ptr+=siz;
+  }
+  return res;
+#else // #ifdef cimg_use_zlib
+  return get_unserialize(buffer);
+#endif // #ifdef cimg_use_zlib
+}
+
+// Load a region of interest (x0,y0)-(x1,y1) from a range of pages of a TIFF file.
+// Only the tiles (or strips) intersecting the region are decoded, in parallel
+// (each thread uses its own TIFF handle, as libtiff handles are not thread-safe).
+#ifdef cimg_use_tiff
+template<typename t>
+static void _load_tiff_roi_tile(const t *const buffer, CImg<T>& img,
+                                const unsigned int tx, const unsigned int ty,
+                                const unsigned int tw, const unsigned int th,
+                                const unsigned int x0, const unsigned int y0,
+                                const unsigned int x1, const unsigned int y1,
+                                const int sample) {
+  const unsigned int
+    xa = std::max(tx,x0), xb = std::min(tx + tw - 1,x1),
+    ya = std::max(ty,y0), yb = std::min(ty + th - 1,y1);
+  if (xa>xb || ya>yb) return;
+  for (unsigned int y = ya; y<=yb; ++y) {
+    if (sample<0) { // Contiguous samples
+      const t *ptrs = buffer + ((cimg_ulong)(y - ty)*tw + xa - tx)*img._spectrum;
+      for (unsigned int x = xa; x<=xb; ++x) cimg_forC(img,c) img(x - x0,y - y0,0,c) = (T)*(ptrs++);
+    } else { // Separate sample planes
+      const t *ptrs = buffer + (cimg_ulong)(y - ty)*tw + xa - tx;
+      T *ptrd = img.data(xa - x0,y - y0,0,sample);
+      for (unsigned int x = xa; x<=xb; ++x) *(ptrd++) = (T)*(ptrs++);
+    }
+  }
+}
+#endif // #ifdef cimg_use_tiff
+
+CImgList<T>& load_tiff_roi(const char *const filename,
+                           const unsigned int first_frame, const unsigned int last_frame,
+                           const unsigned int x0, const unsigned int y0,
+                           const unsigned int x1, const unsigned int y1) {
+  const unsigned int
+    nfirst_frame = std::min(first_frame,last_frame), nlast_frame = std::max(first_frame,last_frame),
+    nx0 = std::min(x0,x1), nx1 = std::max(x0,x1),
+    ny0 = std::min(y0,y1), ny1 = std::max(y0,y1);
+#ifndef cimg_use_tiff
+  load_tiff(filename,nfirst_frame,nlast_frame);
+  cimglist_for(*this,l) _data[l].crop(nx0,ny0,nx1,ny1);
+  return *this;
+#else // #ifndef cimg_use_tiff
+  if (!filename)
+    throw CImgArgumentException(_cimglist_instance
+                                "load_tiff_roi(): Specified filename is (null).",
+                                cimglist_instance);
+  TIFF *const tif = TIFFOpen(filename,"r");
+  if (!tif)
+    throw CImgIOException(_cimglist_instance
+                          "load_tiff_roi(): Failed to open file '%s'.",
+                          cimglist_instance,filename);
+  const unsigned int nb_frames = (unsigned int)TIFFNumberOfDirectories(tif);
+  if (nfirst_frame>=nb_frames) {
+    TIFFClose(tif);
+    throw CImgArgumentException(_cimglist_instance
+                                "load_tiff_roi(): Invalid frame range [%u,%u] for file '%s' (%u frames).",
+                                cimglist_instance,nfirst_frame,nlast_frame,filename,nb_frames);
+  }
+  assign();
+  for (unsigned int frame = nfirst_frame; frame<=std::min(nlast_frame,nb_frames - 1); ++frame) {
+    unsigned short spp = 1, bps = 8, format = SAMPLEFORMAT_UINT, planar = PLANARCONFIG_CONTIG, photo = 0;
+    unsigned int W = 0, H = 0, tw = 0, th = 0;
+    TIFFSetDirectory(tif,(tdir_t)frame);
+    TIFFGetField(tif,TIFFTAG_IMAGEWIDTH,&W);
+    TIFFGetField(tif,TIFFTAG_IMAGELENGTH,&H);
+    TIFFGetFieldDefaulted(tif,TIFFTAG_SAMPLESPERPIXEL,&spp);
+    TIFFGetFieldDefaulted(tif,TIFFTAG_BITSPERSAMPLE,&bps);
+    TIFFGetFieldDefaulted(tif,TIFFTAG_SAMPLEFORMAT,&format);
+    TIFFGetFieldDefaulted(tif,TIFFTAG_PLANARCONFIG,&planar);
+    TIFFGetField(tif,TIFFTAG_PHOTOMETRIC,&photo);
+    if (nx0>=W || ny0>=H) {
+      TIFFClose(tif);
+      throw CImgArgumentException(_cimglist_instance
+                                  "load_tiff_roi(): Region (%u,%u)-(%u,%u) is outside frame %u (%ux%u) "
+                                  "of file '%s'.",
+                                  cimglist_instance,nx0,ny0,nx1,ny1,frame,W,H,filename);
+    }
+    const unsigned int _nx1 = std::min(nx1,W - 1), _ny1 = std::min(ny1,H - 1);
+
+    if ((bps!=8 && bps!=16 && bps!=32 && bps!=64) || photo==PHOTOMETRIC_PALETTE || photo==PHOTOMETRIC_YCBCR ||
+        (format!=SAMPLEFORMAT_UINT && format!=SAMPLEFORMAT_INT && format!=SAMPLEFORMAT_IEEEFP) ||
+        (format==SAMPLEFORMAT_IEEEFP && bps!=32 && bps!=64)) {
+      // Pixel layout not handled here (including 8 or 16 bits floats): decode whole frame and crop.
+      CImgList<T> frames;
+      frames.load_tiff(filename,frame,frame);
+      if (frames) frames[0].crop(nx0,ny0,_nx1,_ny1).move_to(*this);
+      continue;
+    }
+
+    const bool is_tiled = TIFFIsTiled(tif)!=0;
+    if (is_tiled) {
+      TIFFGetField(tif,TIFFTAG_TILEWIDTH,&tw);
+      TIFFGetField(tif,TIFFTAG_TILELENGTH,&th);
+    } else {
+      tw = W;
+      TIFFGetFieldDefaulted(tif,TIFFTAG_ROWSPERSTRIP,&th);
+      th = std::min(th,H);
+    }
+    const unsigned int
+      nb_planes = planar==PLANARCONFIG_SEPARATE?spp:1U,
+      tx0 = nx0/tw, tx1 = _nx1/tw, ty0 = ny0/th, ty1 = _ny1/th,
+      ntx = tx1 - tx0 + 1,
+      nb_tiles = ntx*(ty1 - ty0 + 1)*nb_planes;
+    CImg<T> img(_nx1 - nx0 + 1,_ny1 - ny0 + 1,1,spp);
+    unsigned int nb_errors = 0;
+
+    cimg_pragma_openmp(parallel if (nb_tiles>1)) {
+      TIFF *const _tif = TIFFOpen(filename,"r");
+      const bool is_valid = _tif && TIFFSetDirectory(_tif,(tdir_t)frame);
+      CImg<unsigned char> buffer;
+      if (is_valid) buffer.assign((unsigned int)(is_tiled?TIFFTileSize(_tif):TIFFStripSize(_tif)));
+
+      cimg_pragma_openmp(for schedule(dynamic,1))
+      for (int k = 0; k<(int)nb_tiles; ++k) {
+        const unsigned int
+          plane = k%nb_planes, tile = k/nb_planes,
+          tx = (tx0 + tile%ntx)*tw, ty = (ty0 + tile/ntx)*th;
+        const int sample = nb_planes>1?(int)plane:-1;
+        if (!is_valid ||
+            (is_tiled?TIFFReadTile(_tif,buffer._data,tx,ty,0,(tsample_t)plane):
+             TIFFReadEncodedStrip(_tif,TIFFComputeStrip(_tif,ty,(tsample_t)plane),buffer._data,(tmsize_t)-1))<0) {
+          cimg_pragma_openmp(atomic) ++nb_errors;
+          continue;
+        }
+        switch (format) {
+        case SAMPLEFORMAT_IEEEFP :
+          if (bps==32) _load_tiff_roi_tile((float*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          else _load_tiff_roi_tile((double*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          break;
+        case SAMPLEFORMAT_INT :
+          if (bps==8) _load_tiff_roi_tile((signed char*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          else if (bps==16) _load_tiff_roi_tile((short*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          else if (bps==32) _load_tiff_roi_tile((int*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          else _load_tiff_roi_tile((cimg_int64*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          break;
+        default :
+          if (bps==8) _load_tiff_roi_tile((unsigned char*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          else if (bps==16)
+            _load_tiff_roi_tile((unsigned short*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          else if (bps==32)
+            _load_tiff_roi_tile((unsigned int*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+          else _load_tiff_roi_tile((cimg_uint64*)buffer._data,img,tx,ty,tw,th,nx0,ny0,_nx1,_ny1,sample);
+        }
+      }
+      if (_tif) TIFFClose(_tif);
+    }
+
+    if (nb_errors) {
+      TIFFClose(tif);
+      throw CImgIOException(_cimglist_instance
+                            "load_tiff_roi(): Failed to decode %u tile%s of frame %u in file '%s'.",
+                            cimglist_instance,nb_errors,nb_errors>1?"s":"",frame,filename);
+    }
+    img.move_to(*this);
+  }
+  TIFFClose(tif);
+  return *this;
+#endif // #ifndef cimg_use_tiff
+}
+
 // The method below is a variant of the method 'CImgList<T>::_display()', where
 // G'MIC command 'display2d' is used in place of the native method 'CImg<T>::display()',
 // for displaying 2d images only.
@@ -1932,6 +4135,82 @@ const CImgList<T>& _gmic_display(CImgDisplay &disp, const char *const title, con
   return *this;
 }
 
+// If last image of the list stores the images names of a .gmz file, move them to 'names'
+// and remove this image (return false if list is not the content of a .gmz file).
+bool _gmic_gmz_names(CImgList<charT>& names) {
+  if (!_width) return false;
+  const CImg<T>& back = _data[_width - 1];
+  if (back._width!=1 || back._height<4 || back._depth!=1 || back._spectrum!=1 ||
+      back[0]!='G' || back[1]!='M' || back[2]!='Z' || back[3]) return false;
+  CImg<charT>(back).get_split(CImg<charT>::vector(0),0,false).move_to(names);
+  if (!names) return false;
+  names.remove(0);
+  cimglist_for(names,l) names[l].resize(1,names[l].height() + 1,1,1,0).unroll('x');
+  remove(_width - 1);
+  return true;
+}
+
+// Return 'true' if file extension 'ext' is one of the video formats loaded as image sequences
+// (by command 'input' and 'load_gmic_file()').
+static bool _gmic_is_video_ext(const char *const ext) {
+  static const char *const video_exts[] = {
+    "avi","mov","asf","divx","flv","mpg","m1v","m2v","m4v","mjp","mp4","mkv","mpe","movie",
+    "ogm","ogg","qt","rm","vob","wmv","xvid","mpeg",0 };
+  for (const char *const *p = video_exts; *p; ++p) if (!cimg::strcasecmp(ext,*p)) return true;
+  return false;
+}
+
+// Load images of a file given without file options, with the same format dispatch as command 'input'
+// (used for files matching a glob pattern, which are loaded from several threads).
+// Images names are set in 'names': 'name' for all images, or the names stored in a .gmz file.
+CImgList<T>& load_gmic_file(const char *const filename, CImgList<charT>& names, const char *const name) {
+  const char *const ext = cimg::split_filename(filename), *file_type = 0;
+  if (!*ext) {
+    std::FILE *const file = cimg::fopen(filename,"rb");
+    file_type = cimg::ftype(file,0);
+    cimg::fclose(file);
+  }
+  const bool is_video = _gmic_is_video_ext(ext);
+  assign();
+  names.assign();
+
+  if (!cimg::strcasecmp(ext,"off") || (file_type && !std::strcmp(file_type,"off"))) {
+    CImgList<unsigned int> primitives;
+    CImgList<float> colors;
+    CImg<float> vertices = CImg<float>::get_load_off(primitives,colors,filename);
+    const CImg<float> opacities(1,primitives.size(),1,1,1);
+    vertices.object3dtoCImg3d(primitives,colors,opacities,false).move_to(*this);
+  } else if (!cimg::strcasecmp(ext,"gmz")) {
+    load_cimg_frames(filename,0,~0U);
+    if (!_gmic_gmz_names(names) || names._width!=_width)
+      throw CImgIOException(_cimglist_instance
+                            "load_gmic_file(): File '%s' is not in .gmz format.",
+                            cimglist_instance,filename);
+  } else if (!cimg::strcasecmp(ext,"cimgz")) load_cimg_frames(filename,0,~0U);
+  else if (!cimg::strcasecmp(ext,"cimg")) load_cimg(filename);
+  else if (is_video) load_video(filename);
+  else if (!cimg::strcasecmp(ext,"raw")) CImg<T>::get_load_raw(filename).move_to(*this);
+  else if (!cimg::strcasecmp(ext,"tif") || !cimg::strcasecmp(ext,"tiff") ||
+           (file_type && !std::strcmp(file_type,"tif"))) load_tiff(filename);
+  else if (!cimg::strcasecmp(ext,"yuv") || !cimg::strcasecmp(ext,"gmic"))
+    throw CImgArgumentException(_cimglist_instance
+                                "load_gmic_file(): File '%s' cannot be loaded as images without file options.",
+                                cimglist_instance,filename);
+  else {
+    if (!cimg::strcasecmp(ext,"csv") || !cimg::strcasecmp(ext,"dlm") || !cimg::strcasecmp(ext,"txt")) {
+      // Numeric text file: try fast parser first.
+      try { CImg<T>().load_gmic_dlm(filename).move_to(*this); }
+      catch (CImgException&) { load(filename); }
+    } else load(filename);
+    _gmic_gmz_names(names); // .gmz file without extension
+  }
+  if (!names && _width) {
+    CImg<charT>::string(name).move_to(names);
+    if (_width>1) names.insert(_width - 1,names[0].get_copymark());
+  }
+  return *this;
+}
+
 #undef cimglist_plugin
 
 //--------------- End of CImgList<T> plug-in ------------------------
@@ -2009,6 +4288,7 @@ inline char *_gmic_argument_text(const char *const argument, CImg<char>& argumen
     if (is_get) { \
       images[__ind].get_##function.move_to(images); \
       images_names[__ind].get_copymark().move_to(images_names); \
+      images_names_index.inserted(images_names._width - 1,1); \
     } else images[__ind].function; \
   }
 
@@ -2043,6 +4323,7 @@ inline char *_gmic_argument_text(const char *const argument, CImg<char>& argumen
        if (is_get) { \
          g_img.assign(img,false).function1((value_type1)nvalue).move_to(images); \
          images_names.insert(images_names[selection[l]].get_copymark()); \
+         images_names_index.inserted(images_names._width - 1,1); \
        } else img.function1((value_type1)nvalue); \
      } \
      ++position; \
@@ -2055,6 +4336,7 @@ inline char *_gmic_argument_text(const char *const argument, CImg<char>& argumen
        if (is_get) { \
          g_img.assign(img,false).function2(img0).move_to(images); \
          images_names.insert(images_names[selection[l]].get_copymark()); \
+         images_names_index.inserted(images_names._width - 1,1); \
        } else img.function2(img0); \
      } \
      ++position; \
@@ -2065,6 +4347,7 @@ inline char *_gmic_argument_text(const char *const argument, CImg<char>& argumen
        if (is_get) { \
          g_img.assign(img,false).function3((const char*)formula,images).move_to(images); \
          images_names.insert(images_names[selection[l]].get_copymark()); \
+         images_names_index.inserted(images_names._width - 1,1); \
        } else img.function3((const char*)formula,images); \
      } \
      ++position; \
@@ -2076,6 +4359,7 @@ inline char *_gmic_argument_text(const char *const argument, CImg<char>& argumen
          for (unsigned int l = 1; l<(unsigned int)selection.height(); ++l) \
            g_img.function2(gmic_check(images[selection[l]])); \
          images_names.insert(images_names[selection[0]].get_copymark()); \
+         images_names_index.inserted(images_names._width - 1,1); \
          g_img.move_to(images); \
        } else if (selection.height()>=2) { \
        CImg<T>& img = gmic_check(images[selection[0]]); \
@@ -2183,49 +4467,464 @@ struct _gmic_mutex {
 };
 inline _gmic_mutex& gmic_mutex() { static _gmic_mutex val; return val; }
 
-// Thread structure and routine for command 'parallel'.
-template<typename T>
-struct _gmic_parallel {
-  CImgList<char> *images_names, *parent_images_names, commands_line;
-  CImgList<_gmic_parallel<T> > *gmic_threads;
-  CImgList<T> *images, *parent_images;
-  CImg<unsigned int> variables_sizes;
-  const CImg<unsigned int> *command_selection;
-  bool is_thread_running;
-  gmic_exception exception;
-  gmic gmic_instance;
+// Thread structure and routine for command 'parallel'.
+template<typename T>
+struct _gmic_parallel {
+  CImgList<char> *images_names, *parent_images_names, commands_line;
+  CImgList<_gmic_parallel<T> > *gmic_threads;
+  CImgList<T> *images, *parent_images;
+  CImg<unsigned int> variables_sizes;
+  const CImg<unsigned int> *command_selection;
+  bool is_thread_running;
+  gmic_exception exception;
+  gmic gmic_instance;
+#ifdef gmic_is_parallel
+#ifdef _PTHREAD_H
+  pthread_t thread_id;
+#elif cimg_OS==2
+  HANDLE thread_id;
+#endif // #ifdef _PTHREAD_H
+#endif // #ifdef gmic_is_parallel
+  _gmic_parallel() { variables_sizes.assign(gmic_varslots); }
+};
+
+template<typename T>
+#if cimg_OS!=2
+static void *gmic_parallel(void *arg)
+#else // #if cimg_OS!=2
+static DWORD WINAPI gmic_parallel(void *arg)
+#endif // #if cimg_OS!=2
+{
+  _gmic_parallel<T> &st = *(_gmic_parallel<T>*)arg;
+  try {
+    unsigned int pos = 0;
+    st.gmic_instance.abort_ptr(st.gmic_instance.is_abort);
+    st.gmic_instance.is_debug_info = false;
+    st.gmic_instance._run(st.commands_line,pos,*st.images,*st.images_names,
+                          *st.parent_images,*st.parent_images_names,
+                          st.variables_sizes,0,0,st.command_selection);
+  } catch (gmic_exception &e) {
+    st.exception._command_help.assign(e._command_help);
+    st.exception._message.assign(e._message);
+  }
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  pthread_exit(0);
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  return 0;
+}
+
+// Start thread routine 'gmic_parallel()' (or run it immediately if parallel computing is disabled).
+template<typename T>
+static void gmic_launch_thread(_gmic_parallel<T> &st) {
+#ifdef gmic_is_parallel
+#ifdef _PTHREAD_H
+
+#if defined(__MACOSX__) || defined(__APPLE__)
+  const cimg_uint64 stacksize = (cimg_uint64)8*1024*1024;
+  pthread_attr_t thread_attr;
+  if (!pthread_attr_init(&thread_attr) && !pthread_attr_setstacksize(&thread_attr,stacksize))
+    // Reserve enough stack size for the new thread.
+    pthread_create(&st.thread_id,&thread_attr,gmic_parallel<T>,(void*)&st);
+  else
+#endif // #if defined(__MACOSX__) || defined(__APPLE__)
+    pthread_create(&st.thread_id,0,gmic_parallel<T>,(void*)&st);
+
+#elif cimg_OS==2 // #ifdef _PTHREAD_H
+  st.thread_id = CreateThread(0,0,gmic_parallel<T>,(void*)&st,0,0);
+#endif // #ifdef _PTHREAD_H
+#else // #ifdef gmic_is_parallel
+  gmic_parallel<T>((void*)&st);
+#endif // #ifdef gmic_is_parallel
+}
+
+// Return number of threads to use for a task, as set by environment variable 'name'
+// (default is the number of available cpus).
+static unsigned int gmic_nb_threads(const char *const name) {
+  const char *const s_threads = std::getenv(name);
+  const int nb_threads = s_threads?std::atoi(s_threads):0;
+  return nb_threads>0?(unsigned int)nb_threads:cimg::nb_cpus();
+}
+
+// Job and worker pool for asynchronous outputs ('+output').
+// A fixed number of worker threads save the queued images, and the queue is bounded so that
+// the interpreter blocks (rather than copying more images) when outputs cannot keep up.
+template<typename T>
+struct _gmic_output_job {
+  CImgList<T> images;
+  CImg<char> filename;
+  bool is_dlm;
+
+  // Save images of the job (same as the generic case of command 'output'),
+  // and add an error message to 'errors' for each file that cannot be saved.
+  void save(CImgList<char>& errors) {
+    if (images.size()==1 || !cimg::strcasecmp(cimg::split_filename(filename),"gz")) {
+      try {
+        if (images.size()>1) images.save(filename);
+        else if (is_dlm) images[0].save_gmic_dlm(filename);
+        else images[0].save(filename);
+      } catch (CImgException &e) { add_error(errors,filename,e.what()); }
+      catch (...) { add_error(errors,filename,"Unknown error"); }
+    } else {
+      CImg<char> nfilename(filename._width + 16);
+      cimglist_for(images,l) {
+        cimg::number_filename(filename,l,6,nfilename);
+        try { if (is_dlm) images[l].save_gmic_dlm(nfilename); else images[l].save(nfilename); }
+        catch (CImgException &e) { add_error(errors,nfilename,e.what()); }
+        catch (...) { add_error(errors,nfilename,"Unknown error"); }
+      }
+    }
+    images.assign();
+  }
+
+  static void add_error(CImgList<char>& errors, const char *const filename, const char *const message) {
+    CImg<char> error((unsigned int)(std::strlen(filename) + std::strlen(message) + 64));
+    cimg_snprintf(error,error._width,"Command 'output': Unable to save file '%s' (%s).",filename,message);
+    CImg<char>::string(error).move_to(errors);
+  }
+};
+
+template<typename T>
+#if cimg_OS!=2
+static void *gmic_output_worker(void *arg);
+#else // #if cimg_OS!=2
+static DWORD WINAPI gmic_output_worker(void *arg);
+#endif // #if cimg_OS!=2
+
+template<typename T>
+struct _gmic_output_pool {
+  CImg<_gmic_output_job<T> > jobs; // Queue of pending jobs (ring buffer)
+  CImgList<char> errors;           // Errors raised by completed jobs (one per file that cannot be saved)
+  unsigned int first_job, nb_jobs, nb_running, nb_workers;
+  bool is_stop;
+
+  // Condition [0] is signaled when a job is queued (or the pool is stopped),
+  // condition [1] when a job is dequeued or completed.
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  CImg<pthread_t> workers;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond[2];
+  void lock() { pthread_mutex_lock(&mutex); }
+  void unlock() { pthread_mutex_unlock(&mutex); }
+  void wait(const unsigned int n) { pthread_cond_wait(&cond[n],&mutex); }
+  void signal(const unsigned int n) { pthread_cond_broadcast(&cond[n]); }
+#elif defined(gmic_is_parallel) && cimg_OS==2
+  CImg<HANDLE> workers;
+  HANDLE mutex, cond[2]; // 'cond' are manual-reset events, only reset when the awaited state is false
+  void lock() { WaitForSingleObject(mutex,INFINITE); }
+  void unlock() { ReleaseMutex(mutex); }
+  void wait(const unsigned int n) {
+    ResetEvent(cond[n]); unlock(); WaitForSingleObject(cond[n],INFINITE); lock();
+  }
+  void signal(const unsigned int n) { SetEvent(cond[n]); }
+#else // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  void lock() {}
+  void unlock() {}
+  void wait(const unsigned int) {}
+  void signal(const unsigned int) {}
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+
+  _gmic_output_pool():first_job(0),nb_jobs(0),nb_running(0),nb_workers(0),is_stop(false) {
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+    pthread_mutex_init(&mutex,0); pthread_cond_init(&cond[0],0); pthread_cond_init(&cond[1],0);
+#elif defined(gmic_is_parallel) && cimg_OS==2
+    mutex = CreateMutex(0,FALSE,0); cond[0] = CreateEvent(0,TRUE,FALSE,0); cond[1] = CreateEvent(0,TRUE,FALSE,0);
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  }
+
+  // Complete pending jobs and stop workers.
+  ~_gmic_output_pool() {
+    lock();
+    is_stop = true;
+    signal(0);
+    unlock();
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+    for (unsigned int k = 0; k<nb_workers; ++k) pthread_join(workers[k],0);
+    pthread_mutex_destroy(&mutex); pthread_cond_destroy(&cond[0]); pthread_cond_destroy(&cond[1]);
+#elif defined(gmic_is_parallel) && cimg_OS==2
+    for (unsigned int k = 0; k<nb_workers; ++k) {
+      WaitForSingleObject(workers[k],INFINITE);
+      CloseHandle(workers[k]);
+    }
+    CloseHandle(mutex); CloseHandle(cond[0]); CloseHandle(cond[1]);
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  }
+
+  // Queue images to be saved as file 'filename' (wait if the queue is full).
+  // Workers are started on first use.
+  void push(CImgList<T>& images, const char *const filename, const bool is_dlm) {
+    _gmic_output_job<T> job;
+    images.move_to(job.images);
+    CImg<char>::string(filename).move_to(job.filename);
+    job.is_dlm = is_dlm;
 #ifdef gmic_is_parallel
+    if (!jobs) { // Start workers
+      const unsigned int nb_threads = gmic_nb_threads("GMIC_OUTPUT_THREADS");
+      jobs.assign(2*nb_threads);
+      workers.assign(nb_threads);
+      for (nb_workers = 0; nb_workers<nb_threads; ++nb_workers) {
 #ifdef _PTHREAD_H
-  pthread_t thread_id;
-#elif cimg_OS==2
-  HANDLE thread_id;
+        if (pthread_create(&workers[nb_workers],0,gmic_output_worker<T>,(void*)this)) break;
+#else // #ifdef _PTHREAD_H
+        if (!(workers[nb_workers] = CreateThread(0,0,gmic_output_worker<T>,(void*)this,0,0))) break;
 #endif // #ifdef _PTHREAD_H
+      }
+    }
 #endif // #ifdef gmic_is_parallel
-  _gmic_parallel() { variables_sizes.assign(gmic_varslots); }
+    if (!nb_workers) { job.save(errors); return; } // No threads available: save immediately
+    lock();
+    while (nb_jobs==jobs._width) wait(1);
+    _gmic_output_job<T> &slot = jobs[(first_job + nb_jobs)%jobs._width];
+    job.images.move_to(slot.images);
+    job.filename.move_to(slot.filename);
+    slot.is_dlm = job.is_dlm;
+    ++nb_jobs;
+    signal(0);
+    unlock();
+  }
+
+  // Run next job from a worker thread (return false when the pool is stopped and no jobs remain).
+  bool run_next() {
+    _gmic_output_job<T> job;
+    lock();
+    while (!nb_jobs && !is_stop) wait(0);
+    if (!nb_jobs) { unlock(); return false; }
+    _gmic_output_job<T> &slot = jobs[first_job];
+    slot.images.move_to(job.images);
+    slot.filename.move_to(job.filename);
+    job.is_dlm = slot.is_dlm;
+    first_job = (first_job + 1)%jobs._width;
+    --nb_jobs;
+    ++nb_running;
+    signal(1);
+    unlock();
+    CImgList<char> job_errors;
+    job.save(job_errors);
+    lock();
+    job_errors.move_to(errors,~0U);
+    --nb_running;
+    signal(1);
+    unlock();
+    return true;
+  }
+
+  // Wait for all queued jobs to complete, and return errors raised since last call, one per line
+  // (empty if no errors).
+  CImg<char> sync() {
+    CImgList<char> _errors;
+    lock();
+    while (nb_jobs || nb_running) wait(1);
+    errors.move_to(_errors);
+    unlock();
+    if (!_errors) return CImg<char>();
+    cimglist_for(_errors,l) _errors[l].back() = l<_errors.width() - 1?'\n':0;
+    return _errors>'x';
+  }
 };
 
 template<typename T>
 #if cimg_OS!=2
-static void *gmic_parallel(void *arg)
+static void *gmic_output_worker(void *arg)
 #else // #if cimg_OS!=2
-static DWORD WINAPI gmic_parallel(void *arg)
+static DWORD WINAPI gmic_output_worker(void *arg)
 #endif // #if cimg_OS!=2
 {
-  _gmic_parallel<T> &st = *(_gmic_parallel<T>*)arg;
-  try {
-    unsigned int pos = 0;
-    st.gmic_instance.abort_ptr(st.gmic_instance.is_abort);
-    st.gmic_instance.is_debug_info = false;
-    st.gmic_instance._run(st.commands_line,pos,*st.images,*st.images_names,
-                          *st.parent_images,*st.parent_images_names,
-                          st.variables_sizes,0,0,st.command_selection);
-  } catch (gmic_exception &e) {
-    st.exception._command_help.assign(e._command_help);
-    st.exception._message.assign(e._message);
+  _gmic_output_pool<T> &pool = *(_gmic_output_pool<T>*)arg;
+  while (pool.run_next()) {}
+  return 0;
+}
+
+// Video stream used by command 'input' when successive single frames of a video file are read
+// (e.g. by 'apply_video'). Frames are decoded sequentially from a pipe to 'ffmpeg', by a background thread
+// that fills a bounded ring buffer, so that memory stays constant and decoding overlaps processing.
+// Each interpreter owns its own stream (see 'gmic::video_stream'), released with the interpreter.
+#if cimg_OS!=2
+static void *gmic_video_stream(void *arg);
+#else // #if cimg_OS!=2
+static DWORD WINAPI gmic_video_stream(void *arg);
+#endif // #if cimg_OS!=2
+
+struct _gmic_video_stream {
+  CImg<char> filename, requested_filename;
+  CImgList<unsigned char> ring; // Decoded frames
+  CImg<int> ring_frames;        // Index of the frame stored in each slot of the ring buffer (-1 for a free slot)
+  std::FILE *pipe;
+  unsigned int first_frame, step, requested_frame, next_frame;
+  bool is_stop, is_eof, is_thread, is_failed;
+
+  // All fields shared with the decoding thread are accessed under 'lock()'.
+  // Condition [0] is signaled when a frame has been decoded (or the stream ended),
+  // condition [1] when a slot of the ring buffer has been freed (or the stream is stopped).
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  pthread_t thread_id;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond[2];
+  void lock() { pthread_mutex_lock(&mutex); }
+  void unlock() { pthread_mutex_unlock(&mutex); }
+  void wait(const unsigned int n) { pthread_cond_wait(&cond[n],&mutex); }
+  void signal(const unsigned int n) { pthread_cond_signal(&cond[n]); }
+#elif defined(gmic_is_parallel) && cimg_OS==2
+  HANDLE thread_id, mutex, cond[2]; // 'cond' are manual-reset events, each waited by a single thread
+  void lock() { WaitForSingleObject(mutex,INFINITE); }
+  void unlock() { ReleaseMutex(mutex); }
+  void wait(const unsigned int n) {
+    ResetEvent(cond[n]); unlock(); WaitForSingleObject(cond[n],INFINITE); lock();
+  }
+  void signal(const unsigned int n) { SetEvent(cond[n]); }
+#else // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  void lock() {}
+  void unlock() {}
+  void wait(const unsigned int) {}
+  void signal(const unsigned int) {}
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+
+  _gmic_video_stream():pipe(0),first_frame(0),step(1),requested_frame(~0U),next_frame(0),
+                       is_stop(false),is_eof(true),is_thread(false),is_failed(false) {
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+    pthread_mutex_init(&mutex,0); pthread_cond_init(&cond[0],0); pthread_cond_init(&cond[1],0);
+#elif defined(gmic_is_parallel) && cimg_OS==2
+    mutex = CreateMutex(0,FALSE,0); cond[0] = CreateEvent(0,TRUE,FALSE,0); cond[1] = CreateEvent(0,TRUE,FALSE,0);
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
   }
+
+  ~_gmic_video_stream() {
+    stop();
 #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
-  pthread_exit(0);
+    pthread_mutex_destroy(&mutex); pthread_cond_destroy(&cond[0]); pthread_cond_destroy(&cond[1]);
+#elif defined(gmic_is_parallel) && cimg_OS==2
+    CloseHandle(mutex); CloseHandle(cond[0]); CloseHandle(cond[1]);
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+  }
+
+  // Stop decoding and release resources.
+  void stop() {
+    lock();
+    is_stop = true;
+    signal(1);
+    unlock();
+    if (is_thread) {
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+      pthread_join(thread_id,0);
+#elif defined(gmic_is_parallel) && cimg_OS==2
+      WaitForSingleObject(thread_id,INFINITE);
+      CloseHandle(thread_id);
+#endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+      is_thread = false;
+    }
+    if (pipe) {
+#if cimg_OS==2
+      _pclose(pipe);
+#else // #if cimg_OS==2
+      pclose(pipe);
+#endif // #if cimg_OS==2
+      pipe = 0;
+    }
+    filename.assign(); ring.assign(); ring_frames.assign();
+    is_eof = true;
+  }
+
+  // Start decoding frames 'frame', 'frame + step', ... of specified video file.
+  bool start(const char *const _filename, const unsigned int frame, const unsigned int _step,
+             const unsigned int nb_slots) {
+    stop();
+    const CImg<char>
+      s_ffmpeg = CImg<char>::string(cimg::ffmpeg_path())._system_strescape(),
+      s_filename = CImg<char>::string(_filename)._system_strescape();
+    CImg<char> command(s_ffmpeg._width + s_filename._width + 1024);
+    cimg_snprintf(command,command._width,
+                  "\"%s\" -v -8 -i \"%s\" -vf \"select=gte(n\\,%u)*not(mod(n-%u\\,%u))\" -vsync 0 "
+                  "-f image2pipe -vcodec ppm -pix_fmt rgb24 -",
+                  s_ffmpeg.data(),s_filename.data(),frame,frame,_step);
+#if cimg_OS==2
+    pipe = _popen(command,"rb");
+#else // #if cimg_OS==2
+    pipe = popen(command,"r");
+#endif // #if cimg_OS==2
+    if (!pipe) return false;
+    CImg<char>::string(_filename).move_to(filename);
+    ring.assign(nb_slots);
+    ring_frames.assign(nb_slots).fill(-1);
+    first_frame = next_frame = frame;
+    step = _step;
+    is_stop = is_eof = false;
+#if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+    is_thread = !pthread_create(&thread_id,0,gmic_video_stream,(void*)this);
+#elif defined(gmic_is_parallel) && cimg_OS==2
+    thread_id = CreateThread(0,0,gmic_video_stream,(void*)this,0,0);
+    is_thread = thread_id!=0;
 #endif // #if defined(gmic_is_parallel) && defined(_PTHREAD_H)
+    return true;
+  }
+
+  // Decode next frame into a free slot of the ring buffer (return false at the end of the stream).
+  // When run from the decoding thread, wait until a slot is available.
+  bool decode_next() {
+    int slot = -1;
+    lock();
+    for (;;) {
+      if (is_stop || is_eof) { unlock(); return false; }
+      cimg_forX(ring_frames,k) if (ring_frames[k]<0) { slot = k; break; }
+      if (slot>=0) break;
+      if (!is_thread) { unlock(); return false; } // Ring buffer is full
+      wait(1);
+    }
+    unlock();
+    CImg<unsigned char> frame;
+    try { frame.load_pnm(pipe); } catch (...) { frame.assign(); }
+    lock();
+    if (frame) { frame.move_to(ring[slot]); ring_frames[slot] = (int)next_frame; next_frame+=step; }
+    else is_eof = true;
+    const bool res = !is_eof && !is_stop;
+    signal(0);
+    unlock();
+    return res;
+  }
+
+  // Tell if specified frame will be decoded by the stream.
+  bool is_reachable(const char *const _filename, const unsigned int frame) {
+    lock();
+    const bool res = filename && !std::strcmp(filename,_filename) && !is_eof &&
+      frame>=first_frame && !((frame - first_frame)%step) &&
+      (requested_frame==~0U || frame>requested_frame) && frame<next_frame + ring._width*step;
+    unlock();
+    return res;
+  }
+
+  // Get specified frame from the stream (return false if frame is not available).
+  template<typename T>
+  bool get(const unsigned int frame, CImg<T>& res) {
+    bool is_found = false;
+    lock();
+    for (;;) {
+      bool is_freed = false;
+      cimg_forX(ring_frames,k) if (ring_frames[k]>=0 && ring_frames[k]<=(int)frame) { // Also discard older frames
+        if (ring_frames[k]==(int)frame) { res.assign(ring[k]); is_found = true; }
+        ring[k].assign();
+        ring_frames[k] = -1;
+        is_freed = true;
+      }
+      if (is_freed) signal(1);
+      if (is_found || is_eof) break;
+      if (is_thread) wait(0);
+      else {
+        unlock();
+        const bool is_decoded = decode_next();
+        lock();
+        if (!is_decoded) is_eof = true;
+      }
+    }
+    unlock();
+    return is_found;
+  }
+};
+
+#if cimg_OS!=2
+static void *gmic_video_stream(void *arg)
+#else // #if cimg_OS!=2
+static DWORD WINAPI gmic_video_stream(void *arg)
+#endif // #if cimg_OS!=2
+{
+  _gmic_video_stream &vs = *(_gmic_video_stream*)arg;
+  while (vs.decode_next()) {}
   return 0;
 }
 
@@ -2257,7 +4956,7 @@ const char *gmic::builtin_commands_names[] = {
     "rm","rol","ror","rotate","rotate3d","round","rows","rv","rv3d",
   "s","s3d","screen","select","serialize","set","sh","shared","sharpen","shift","sign","sin","sinc","sinh","skip",
     "sl3d","slices","smooth","solve","sort","specl3d","specs3d","sphere3d","split","split3d","sqr","sqrt","srand",
-    "ss3d","status","streamline3d","structuretensors","sub","sub3d","svd",
+    "ss3d","status","streamline3d","structuretensors","sub","sub3d","svd","sync",
   "t","tan","tanh","text","trisolve",
   "u","uncommand","unroll","unserialize",
   "v","vanvliet","verbose",
@@ -2344,6 +5043,174 @@ void gmic::wait_threads(void *const p_gmic_threads, const bool try_abort, const
 #endif // #ifdef gmic_is_parallel
 }
 
+// Incremental index of image names, used to resolve labels ('[name]', '$name') without scanning the list.
+// One index lives in each call to '_run()', and indexes of nested calls are stacked in 'gmic::names_index'.
+// Commands that rename, reorder, insert or remove images update it with 'renamed()', 'inserted()' and
+// 'removed()'. Any other change of the list size or buffer is detected and triggers a rebuild on next lookup.
+struct _gmic_names_index {
+  void *&top, *const prev;
+  const CImgList<char> &list;
+  const unsigned int &nb_threads;
+  const CImg<char> *data;
+  unsigned int width;
+  bool is_valid, is_enabled;
+  CImg<unsigned int> hashes;      // Hashcode of each image name.
+  CImgList<unsigned int> buckets; // For each bucket: number of entries, then image positions in increasing order.
+
+  // 'nb_threads' is the number of thread groups launched by the current run. Images names may be modified
+  // by those threads, so the index is not used until they are done. A nested run on the same list
+  // (e.g. from 'ext()' in the math parser) disables its own index and invalidates the enclosing one.
+  _gmic_names_index(void *&_top, const CImgList<char>& _list, const unsigned int& _nb_threads,
+                    const bool is_thread):
+    top(_top),prev(_top),list(_list),nb_threads(_nb_threads),data(0),width(0),
+    is_valid(false),is_enabled(!is_thread) {
+    if (find(prev,list)) is_enabled = false;
+    top = (void*)this;
+  }
+
+  ~_gmic_names_index() {
+    top = prev;
+    if (!is_enabled) invalidate(prev,list);
+  }
+
+  static unsigned int hashcode(const char *const str) {
+    unsigned int hash = 0U;
+    for (const char *s = str; *s; ++s) (hash*=31)+=*s;
+    return hash;
+  }
+
+  // Return index of the innermost run working on 'list' (or 0 if none).
+  static _gmic_names_index *find(void *const top, const CImgList<char>& list) {
+    for (_gmic_names_index *p = (_gmic_names_index*)top; p; p = (_gmic_names_index*)p->prev)
+      if (&p->list==&list) return p;
+    return 0;
+  }
+
+  static void invalidate(void *const top, const CImgList<char>& list) {
+    for (_gmic_names_index *p = (_gmic_names_index*)top; p; p = (_gmic_names_index*)p->prev)
+      if (&p->list==&list) p->is_valid = false;
+  }
+
+  // Return usable index of the innermost run working on 'list', rebuilt if necessary (or 0 if none).
+  static _gmic_names_index *get(void *const top, const CImgList<char>& list) {
+    _gmic_names_index *const p = find(top,list);
+    if (!p || !p->is_enabled || p->nb_threads) return 0;
+    if (!p->begin()) p->rebuild();
+    return p;
+  }
+
+  // Tell if index is in sync with the list, before it gets updated.
+  bool begin() {
+    if (!is_enabled || nb_threads || list._width!=width || list._data!=data) is_valid = false;
+    return is_valid;
+  }
+
+  void rebuild() {
+    unsigned int nb_buckets = 64;
+    while (nb_buckets<list._width) nb_buckets<<=1;
+    buckets.assign(nb_buckets);
+    hashes.assign(std::max(list._width,1U));
+    data = list._data; width = list._width;
+    for (unsigned int pos = 0; pos<width; ++pos) add(pos);
+    is_valid = true;
+  }
+
+  void add(const unsigned int pos) {
+    const CImg<char> &name = list[pos];
+    if (!name) return;
+    const unsigned int hash = hashes[pos] = hashcode(name);
+    CImg<unsigned int> &bucket = buckets[hash&(buckets._width - 1)];
+    if (!bucket) bucket.assign(4,1,1,1,0);
+    else if (bucket[0] + 1>=bucket._width) bucket.resize(2*bucket._width,1,1,1,0);
+    unsigned int i = ++bucket[0];
+    for ( ; i>1 && bucket[i - 1]>pos; --i) bucket[i] = bucket[i - 1];
+    bucket[i] = pos;
+  }
+
+  void del(const unsigned int pos) {
+    CImg<unsigned int> &bucket = buckets[hashes[pos]&(buckets._width - 1)];
+    if (!bucket) return;
+    unsigned int &nb = bucket[0];
+    for (unsigned int i = 1; i<=nb; ++i) if (bucket[i]==pos) {
+        for (++i; i<=nb; ++i) bucket[i - 1] = bucket[i];
+        --nb; return;
+      }
+  }
+
+  // Images [pos0..pos1] have been reordered ('is_synced' is the value returned by 'begin()' before).
+  void reordered(const bool is_synced, const unsigned int pos0, const unsigned int pos1) {
+    if (!is_synced || !is_valid || list._width!=width) { is_valid = false; return; }
+    data = list._data;
+    for (unsigned int pos = pos0; pos<=pos1 && pos<width; ++pos) { del(pos); add(pos); }
+  }
+
+  // Images [pos0..pos1] have been renamed (list layout unchanged).
+  void renamed(const unsigned int pos0, const unsigned int pos1) {
+    if (!begin()) return;
+    for (unsigned int pos = pos0; pos<=pos1 && pos<width; ++pos) { del(pos); add(pos); }
+  }
+
+  // 'nb' images have been inserted at position 'pos'.
+  void inserted(const unsigned int pos, const unsigned int nb) {
+    if (!is_valid || !is_enabled || nb_threads || list._width!=width + nb || pos>width) {
+      is_valid = false; return;
+    }
+    if (list._width>2*buckets._width) { rebuild(); return; }
+    if (pos<width) cimglist_for(buckets,b) {
+        CImg<unsigned int> &bucket = buckets[b];
+        if (bucket) for (unsigned int i = bucket[0]; i && bucket[i]>=pos; --i) bucket[i]+=nb;
+      }
+    if (hashes._width<list._width) hashes.resize(std::max(2*hashes._width,list._width),1,1,1,0);
+    for (unsigned int k = width; k>pos; --k) hashes[k - 1 + nb] = hashes[k - 1];
+    data = list._data; width = list._width;
+    for (unsigned int k = 0; k<nb; ++k) add(pos + k);
+  }
+
+  // Images 'selection[start..end]' have been removed ('begin()' must have been called before removal).
+  void removed(const CImg<unsigned int>& selection, const unsigned int start, const unsigned int end) {
+    const unsigned int nb = end - start + 1, pos0 = selection[start];
+    if (!is_valid || list._width!=width - nb) { is_valid = false; return; }
+    for (unsigned int l = start; l<=end; ++l) del(selection[l]);
+    cimglist_for(buckets,b) {
+      CImg<unsigned int> &bucket = buckets[b];
+      if (bucket) for (unsigned int i = bucket[0]; i && bucket[i]>pos0; --i) {
+          unsigned int l0 = start, l1 = end + 1; // Number of removed positions lower than 'bucket[i]'
+          while (l0<l1) { const unsigned int l = (l0 + l1)/2; if (selection[l]<bucket[i]) l0 = l + 1; else l1 = l; }
+          bucket[i]-=l0 - start;
+        }
+    }
+    unsigned int l = start, npos = pos0;
+    for (unsigned int pos = pos0; pos<width; ++pos)
+      if (l<=end && pos==selection[l]) ++l; else hashes[npos++] = hashes[pos];
+    data = list._data; width = list._width;
+  }
+
+  // Return position of the latest image named 'name' before 'pos_max' (or -1 if none).
+  int last(const char *const name, const unsigned int pos_max) const {
+    const unsigned int hash = hashcode(name);
+    const CImg<unsigned int> &bucket = buckets[hash&(buckets._width - 1)];
+    if (bucket) for (unsigned int i = bucket[0]; i; --i) {
+        const unsigned int pos = bucket[i];
+        if (pos<pos_max && hashes[pos]==hash && !std::strcmp(list[pos],name)) return (int)pos;
+      }
+    return -1;
+  }
+
+  // Return positions of all images named 'name' before 'pos_max', in increasing order.
+  CImg<unsigned int> all(const char *const name, const unsigned int pos_max) const {
+    const unsigned int hash = hashcode(name);
+    const CImg<unsigned int> &bucket = buckets[hash&(buckets._width - 1)];
+    if (!bucket || !bucket[0]) return CImg<unsigned int>();
+    CImg<unsigned int> res(1,bucket[0]);
+    unsigned int nb = 0;
+    for (unsigned int i = 1; i<=bucket[0]; ++i) {
+      const unsigned int pos = bucket[i];
+      if (pos<pos_max && hashes[pos]==hash && !std::strcmp(list[pos],name)) res[nb++] = pos;
+    }
+    return nb?res.resize(1,nb,1,1,0):CImg<unsigned int>();
+  }
+};
+
 // Return a hashcode from a string.
 unsigned int gmic::hashcode(const char *const str, const bool is_variable) {
   if (!str) return 0U;
@@ -2440,7 +5307,7 @@ unsigned int gmic::strescape(const char *const str, char *const res) {
     commands_has_arguments(new CImgList<char>[gmic_comslots]), \
     _variables(new CImgList<char>[gmic_varslots]), _variables_names(new CImgList<char>[gmic_varslots]), \
     variables(new CImgList<char>*[gmic_varslots]), variables_names(new CImgList<char>*[gmic_varslots]), \
-    is_running(false)
+    video_stream(0), names_index(0), is_running(false)
 
 #define display_window(n) (*(CImgDisplay*)display_windows[n])
 
@@ -2467,6 +5334,7 @@ gmic::gmic(const char *const commands_line, const char *const custom_commands,
 gmic::~gmic() {
   cimg::exception_mode(cimg_exception_mode);
   cimg_forX(display_windows,l) delete &display_window(l);
+  delete (_gmic_video_stream*)video_stream;
   cimg::mutex(21);
 #if defined(__MACOSX__) || defined(__APPLE__)
   void* tid = (void*)(cimg_ulong)getpid();
@@ -3064,6 +5932,28 @@ CImg<unsigned int> gmic::selection2cimg(const char *const string, const unsigned
   } else if (*string=='-' && string[1]>='0' && string[2]<='9' && !string[2]) { // Single negative digit
     const unsigned int ind = index_max - string[1] + '0';
     if (ind<index_max) return CImg<unsigned int>::vector(ind);
+  } else if (index_max && names &&
+             ((*string>='a' && *string<='z') || (*string>='A' && *string<='Z') || *string=='_')) {
+    const char *s = string + 1;
+    while ((*s>='a' && *s<='z') || (*s>='A' && *s<='Z') || (*s>='0' && *s<='9') || *s=='_') ++s;
+    float f;
+    char end;
+    if (!*s && s - string<256 && // Single label (not 'inf' or 'nan', read as indices below)
+        ((*string!='i' && *string!='I' && *string!='n' && *string!='N') ||
+         cimg_sscanf(string,"%f%c",&f,&end)!=1)) {
+      const unsigned int nb_names = std::min(index_max,names._width);
+      const _gmic_names_index *const pindex = _gmic_names_index::get(names_index,names);
+      if (pindex) {
+        CImg<unsigned int> res = pindex->all(string,nb_names);
+        if (res) return res;
+      } else {
+        CImg<unsigned int> res(1,nb_names);
+        unsigned int nb = 0;
+        for (unsigned int l = 0; l<nb_names; ++l)
+          if (names[l] && !std::strcmp(names[l],string)) res[nb++] = l;
+        if (nb) return res.resize(1,nb,1,1,0);
+      }
+    }
   }
 
   // Manage remaining cases.
@@ -3110,9 +6000,14 @@ CImg<unsigned int> gmic::selection2cimg(const char *const string, const unsigned
       iind1 = (int)cimg::round(ind1);
     } else if (cimg_sscanf(item,"%255[a-zA-Z0-9_]%c",name.data(),&end)==1 && // Label
                (*name<'0' || *name>'9')) {
-      cimglist_for(names,l) if (names[l] && !std::strcmp(names[l],name)) {
-        is_selected(l) = true; is_label = true;
-      }
+      const _gmic_names_index *const pindex = _gmic_names_index::get(names_index,names);
+      if (pindex) {
+        const CImg<unsigned int> inds = pindex->all(name,index_max);
+        cimg_forY(inds,l) is_selected(inds[l]) = true;
+        if (inds) is_label = true;
+      } else cimglist_for(names,l) if (names[l] && !std::strcmp(names[l],name)) {
+          is_selected(l) = true; is_label = true;
+        }
       if (!is_label) {
         if (new_name) {
           iind0 = iind1 = -1;
@@ -3500,14 +6395,25 @@ template<typename T>
 gmic& gmic::remove_images(CImgList<T> &images, CImgList<char> &images_names,
                           const CImg<unsigned int>& selection,
                           const unsigned int start, const unsigned int end) {
+  _gmic_names_index *const pindex = _gmic_names_index::find(names_index,images_names);
+  const bool is_indexed = pindex && pindex->begin();
   if (start==0 && end==(unsigned int)selection.height() - 1 && selection.height()==images.width()) {
     images.assign();
     images_names.assign();
-  } else for (int l = (int)end; l>=(int)start; ) {
-      unsigned int eind = selection[l--], ind = eind;
-      while (l>=(int)start && selection[l]==ind - 1) ind = selection[l--];
-      images.remove(ind,eind); images_names.remove(ind,eind);
-    }
+  } else if (start<=end) {
+    // Compact lists in a single pass, then remove their tail at once
+    // (avoid shifting the whole list for each range of removed images).
+    unsigned int l = start, nind = selection[start];
+    for (unsigned int ind = nind; ind<images._width; ++ind)
+      if (l<=end && ind==selection[l]) ++l;
+      else {
+        images[nind].swap(images[ind]);
+        images_names[nind].swap(images_names[ind]);
+        ++nind;
+      }
+    images.remove(nind,images._width - 1); images_names.remove(nind,images_names._width - 1);
+  }
+  if (is_indexed && start<=end) pindex->removed(selection,start,end);
   return *this;
 }
 
@@ -3912,6 +6818,7 @@ CImg<char> gmic::substitute_item(const char *const source,
                                  const unsigned int *const variables_sizes,
                                  const CImg<unsigned int> *const command_selection,
                                  const bool is_image_expr) {
+  typedef typename cimg::last<T,cimg_ulong>::type ulongT;
   if (!source) return CImg<char>();
   CImg<char> substituted_items(64), inbraces, substr(40), vs;
   char *ptr_sub = substituted_items.data();
@@ -4241,8 +7148,7 @@ CImg<char> gmic::substitute_item(const char *const source,
               is_substituted = true;
               break;
             case 't' : { // Ascii string from image values
-              const unsigned int siz = (unsigned int)img.size();
-              if (siz) {
+              if (img) {
                 unsigned int strsiz = 0;
                 cimg_for(img,ptr,T) if ((unsigned char)*ptr) ++strsiz; else break;
                 if (strsiz) {
@@ -4293,7 +7199,8 @@ CImg<char> gmic::substitute_item(const char *const source,
                 CImg<char> _status;
                 status.move_to(_status); // Save status because 'selection2cimg' may change it
                 try {
-                  const CImg<unsigned int> inds = selection2cimg(subset,(unsigned int)img.size(),
+                  const CImg<unsigned int> inds = selection2cimg(subset,
+                                                                 (unsigned int)std::min(img.size(),(ulongT)~0U),
                                                                  CImgList<char>::empty(),"",false);
                   values.assign(1,inds.height());
                   cimg_foroff(inds,q) values[q] = img[inds[q]];
@@ -4479,10 +7386,12 @@ CImg<char> gmic::substitute_item(const char *const source,
             CImg<char>(__variables[ind].data(),(unsigned int)(__variables[ind].size() - 1)).
               append_string_to(substituted_items,ptr_sub);
         } else {
-          for (int l = images.width() - 1; l>=0; --l)
-            if (images_names[l] && !std::strcmp(images_names[l],name)) {
-              is_name_found = true; ind = l; break;
-            }
+          const _gmic_names_index *const pindex = _gmic_names_index::get(names_index,images_names);
+          if (pindex) is_name_found = (ind = pindex->last(name,images._width))>=0;
+          else for (int l = images.width() - 1; l>=0; --l)
+                 if (images_names[l] && !std::strcmp(images_names[l],name)) {
+                   is_name_found = true; ind = l; break;
+                 }
           if (is_name_found) { // Latest image index
             cimg_snprintf(substr,substr.width(),"%d",ind);
             CImg<char>(substr.data(),(unsigned int)std::strlen(substr),1,1,1,true).
@@ -4631,6 +7540,9 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
   const unsigned int initial_callstack_size = callstack.size(), initial_debug_line = debug_line;
 
   CImgList<_gmic_parallel<T> > gmic_threads;
+  _gmic_names_index images_names_index(names_index,images_names,gmic_threads._width,
+                                       callstack && !std::strncmp(callstack.back(),"*thread",7));
+  _gmic_output_pool<T> output_pool;
   CImgList<unsigned int> primitives;
   CImgList<unsigned char> g_list_uc;
   CImgList<float> g_list_f;
@@ -4987,7 +7899,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
         if (!command1) { // Single-char shortcut
           const bool
             is_mquvx = command0=='m' || command0=='q' || command0=='u' || command0=='v' || command0=='x',
-            is_deiopwx = command0=='d' || command0=='e' || command0=='i' || command0=='o' || command0=='p' ||
+            is_deiopwx = command0=='d' || command0=='e' || command0=='i' || command0=='p' ||
                          command0=='w' || command0=='x';
           if ((unsigned int)command0<128 && onechar_shortcuts[(unsigned int)command0] &&
               (!is_mquvx || (!is_get && !is_selection)) &&
@@ -5369,7 +8281,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
               cimg_forY(selection,l) gmic_apply(gmic_blur(g_img[0],g_img[1],g_img[2],g_img[3],
                                                           (bool)boundary,(bool)is_gaussian));
               g_img.assign();
-            } else cimg_forY(selection,l) gmic_apply(blur(sigma,(bool)boundary,(bool)is_gaussian));
+            } else cimg_forY(selection,l) gmic_apply(gmic_blur(sigma,(bool)boundary,(bool)is_gaussian));
           } else arg_error("blur");
           is_released = false; ++position; continue;
         }
@@ -5477,7 +8389,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             const CImg<T> guide = gmic_image_arg(*ind);
             if (sep0=='%') sigma_s = -sigma_s;
             if (sep1=='%') sigma_r = -sigma_r;
-            cimg_forY(selection,l) gmic_apply(blur_bilateral(guide,sigma_s,sigma_r,sampling_s,sampling_r));
+            cimg_forY(selection,l) gmic_apply(gmic_blur_bilateral(guide,sigma_s,sigma_r,sampling_s,sampling_r));
           } else if ((cimg_sscanf(argument,"%255[0-9.eE%+-],%255[0-9.eE%+-]%c",
                                   argx,argy,&end)==2 ||
                       cimg_sscanf(argument,"%255[0-9.eE%+-],%255[0-9.eE%+-],%f,%f%c",
@@ -5496,7 +8408,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             if (sep0=='%') sigma_s = -sigma_s;
             if (sep1=='%') sigma_r = -sigma_r;
             cimg_forY(selection,l)
-              gmic_apply(blur_bilateral(images[selection[l]],sigma_s,sigma_r,sampling_s,sampling_r));
+              gmic_apply(gmic_blur_bilateral(images[selection[l]],sigma_s,sigma_r,sampling_s,sampling_r));
           } else arg_error("bilateral");
           is_released = false; ++position; continue;
         }
@@ -6023,15 +8935,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                   channel_mode==1?"one-for-one":"expand",
                   *argx?argx:"",*argy?argy:"",*argz?argz:"",*argc?argc:"");
             const CImg<T> kernel = gmic_image_arg(*ind);
-            if (is_cond) {
-              cimg_forY(selection,l) gmic_apply(convolve(kernel,boundary,(bool)is_normalized,channel_mode,
-                                                         xcenter,ycenter,zcenter,xstart,ystart,zstart,xend,yend,zend,
-                                                         xstride,ystride,zstride,xdilation,ydilation,zdilation));
-            } else {
-              cimg_forY(selection,l) gmic_apply(correlate(kernel,boundary,(bool)is_normalized,channel_mode,
-                                                          xcenter,ycenter,zcenter,xstart,ystart,zstart,xend,yend,zend,
-                                                          xstride,ystride,zstride,xdilation,ydilation,zdilation));
-            }
+            cimg_forY(selection,l) gmic_apply(gmic_correlate(kernel,boundary,(bool)is_normalized,channel_mode,
+                                                            xcenter,ycenter,zcenter,xstart,ystart,zstart,
+                                                            xend,yend,zend,xstride,ystride,zstride,
+                                                            xdilation,ydilation,zdilation,is_cond));
           } else arg_error(is_cond?"convolve":"correlate");
           is_released = false; ++position; continue;
         }
@@ -6428,7 +9335,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                   boundary?"neumann":"dirichlet",
                   is_real?"real":"binary");
             const CImg<T> kernel = gmic_image_arg(*ind);
-            cimg_forY(selection,l) gmic_apply(dilate(kernel,(bool)boundary,(bool)is_real));
+            cimg_forY(selection,l) gmic_apply(gmic_dilate(kernel,(bool)boundary,(bool)is_real));
           } else if ((cimg_sscanf(argument,"%f%c",
                                   &sx,&end)==1) &&
                      sx>=0) {
@@ -6436,7 +9343,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             print(images,0,"Dilate image%s with kernel of size %g and neumann boundary conditions.",
                   gmic_selection.data(),
                   sx);
-            cimg_forY(selection,l) gmic_apply(dilate((unsigned int)sx));
+            cimg_forY(selection,l) gmic_apply(gmic_dilate((unsigned int)sx));
           } else if ((cimg_sscanf(argument,"%f,%f%c",
                                   &sx,&sy,&end)==2 ||
                       cimg_sscanf(argument,"%f,%f,%f%c",
@@ -6448,7 +9355,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             print(images,0,"Dilate image%s with %gx%gx%g kernel and neumann boundary conditions.",
                   gmic_selection.data(),
                   sx,sy,sz);
-            cimg_forY(selection,l) gmic_apply(dilate((unsigned int)sx,(unsigned int)sy,(unsigned int)sz));
+            cimg_forY(selection,l) gmic_apply(gmic_dilate((unsigned int)sx,(unsigned int)sy,(unsigned int)sz));
           } else arg_error("dilate");
           is_released = false; ++position; continue;
         }
@@ -7050,7 +9957,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                   boundary?"neumann":"dirichlet",
                   is_real?"real":"binary");
             const CImg<T> kernel = gmic_image_arg(*ind);
-            cimg_forY(selection,l) gmic_apply(erode(kernel,(bool)boundary,(bool)is_real));
+            cimg_forY(selection,l) gmic_apply(gmic_erode(kernel,(bool)boundary,(bool)is_real));
           } else if ((cimg_sscanf(argument,"%f%c",
                                   &sx,&end)==1) &&
                      sx>=0) {
@@ -7058,7 +9965,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             print(images,0,"Erode image%s with kernel of size %g and neumann boundary conditions.",
                   gmic_selection.data(),
                   sx);
-            cimg_forY(selection,l) gmic_apply(erode((unsigned int)sx));
+            cimg_forY(selection,l) gmic_apply(gmic_erode((unsigned int)sx));
           } else if ((cimg_sscanf(argument,"%f,%f%c",
                                   &sx,&sy,&end)==2 ||
                       cimg_sscanf(argument,"%f,%f,%f%c",
@@ -7070,7 +9977,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             print(images,0,"Erode image%s with %gx%gx%g kernel and neumann boundary conditions.",
                   gmic_selection.data(),
                   sx,sy,sz);
-            cimg_forY(selection,l) gmic_apply(erode((unsigned int)sx,(unsigned int)sy,(unsigned int)sz));
+            cimg_forY(selection,l) gmic_apply(gmic_erode((unsigned int)sx,(unsigned int)sy,(unsigned int)sz));
           } else arg_error("erode");
           is_released = false; ++position; continue;
         }
@@ -8018,7 +10925,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           gmic_substitute_args(true);
           float patch_size = 11, lookup_size = 22, lookup_factor = 0.5, lookup_increment = 1,
             blend_size = 0, blend_threshold = 0, blend_decay = 0.05f, blend_scales = 10;
-          unsigned int is_blend_outer = 1, method = 1;
+          unsigned int is_blend_outer = 1, is_pyramid = 0, method = 1;
           sep = *indices = 0;
           if (((cimg_sscanf(argument,"[%255[a-zA-Z0-9_.%+-]%c%c",indices,&sep,&end)==2 &&
                 sep==']') ||
@@ -8062,11 +10969,15 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                       cimg_sscanf(argument,"[%255[a-zA-Z0-9_.%+-]],%f,%f,%f,%f,%f,%f,%f,%f,%u%c",
                                   indices,&patch_size,&lookup_size,&lookup_factor,
                                   &lookup_increment,&blend_size,&blend_threshold,&blend_decay,
-                                  &blend_scales,&is_blend_outer,&end)==10) &&
+                                  &blend_scales,&is_blend_outer,&end)==10 ||
+                      cimg_sscanf(argument,"[%255[a-zA-Z0-9_.%+-]],%f,%f,%f,%f,%f,%f,%f,%f,%u,%u%c",
+                                  indices,&patch_size,&lookup_size,&lookup_factor,
+                                  &lookup_increment,&blend_size,&blend_threshold,&blend_decay,
+                                  &blend_scales,&is_blend_outer,&is_pyramid,&end)==11) &&
                      (ind=selection2cimg(indices,images.size(),images_names,"inpaint")).height()==1 &&
                      patch_size>=0.5 && lookup_size>=0.5 && lookup_factor>=0 &&
                      blend_size>=0 && blend_threshold>=0 && blend_threshold<=1 &&
-                     blend_decay>=0 && blend_scales>=0.5 && is_blend_outer<=1) {
+                     blend_decay>=0 && blend_scales>=0.5 && is_blend_outer<=1 && is_pyramid<=1) {
             const CImg<T> mask = gmic_image_arg(*ind);
             patch_size = cimg::round(patch_size);
             lookup_size = cimg::round(lookup_size);
@@ -8075,18 +10986,20 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             blend_scales = cimg::round(blend_scales);
             print(images,0,"Inpaint image%s masked by image [%d], with patch size %g, "
                   "lookup size %g, lookup factor %g, lookup_increment %g, blend size %g, "
-                  "blend threshold %g, blend decay %g, %g blend scale%s and outer blending %s.",
+                  "blend threshold %g, blend decay %g, %g blend scale%s, outer blending %s "
+                  "and coarse-to-fine lookup %s.",
                   gmic_selection.data(),*ind,
                   patch_size,lookup_size,lookup_factor,lookup_increment,
                   blend_size,blend_threshold,blend_decay,blend_scales,blend_scales!=1?"s":"",
-                  is_blend_outer?"enabled":"disabled");
+                  is_blend_outer?"enabled":"disabled",
+                  is_pyramid?"enabled":"disabled");
             cimg_forY(selection,l)
               gmic_apply(inpaint_patch(mask,
                                        (unsigned int)patch_size,(unsigned int)lookup_size,
                                        lookup_factor,
                                        (int)lookup_increment,
                                        (unsigned int)blend_size,blend_threshold,blend_decay,
-                                       (unsigned int)blend_scales,(bool)is_blend_outer));
+                                       (unsigned int)blend_scales,(bool)is_blend_outer,(bool)is_pyramid));
           } else arg_error("inpaint");
           is_released = false; ++position; continue;
         }
@@ -8112,6 +11025,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             }
             g_list.move_to(images,~0U);
             g_list_c.move_to(images_names,~0U);
+            images_names_index.inserted(images_names._width - selection.height(),selection.height());
           } else {
             cimg_forY(selection,l) {
               const unsigned int uind = selection[l];
@@ -8120,6 +11034,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             }
             g_list.swap(images);
             g_list_c.swap(images_names);
+            images_names_index.is_valid = false;
           }
           if (is_verbose) {
             cimg::mutex(29);
@@ -8228,8 +11143,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           }
           callstack.remove();
           if (is_get) {
+            const unsigned int nb = g_list_c.size();
             g_list.move_to(images,~0U);
             g_list_c.move_to(images_names,~0U);
+            images_names_index.inserted(images_names._width - nb,nb);
           } else {
             const unsigned int nb = std::min((unsigned int)selection.height(),g_list.size());
             if (nb>0) {
@@ -8240,6 +11157,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                   g_list[i].assign();
                 } else images[uind].swap(g_list[i]);
                 images_names[uind].swap(g_list_c[i]);
+                images_names_index.renamed(uind,uind);
               }
               g_list.remove(0,nb - 1);
               g_list_c.remove(0,nb - 1);
@@ -8247,9 +11165,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             if (nb<(unsigned int)selection.height())
               remove_images(images,images_names,selection,nb,selection.height() - 1);
             else if (g_list) {
-              const unsigned int uind0 = selection?selection.back() + 1:images.size();
+              const unsigned int uind0 = selection?selection.back() + 1:images.size(), nb = g_list_c.size();
               images.insert(g_list,uind0);
               g_list_c.move_to(images_names,uind0);
+              images_names_index.inserted(uind0,nb);
             }
           }
           g_list.assign(); g_list_c.assign();
@@ -8363,7 +11282,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                 "Label connected components on image%s, with tolerance %g and "
                 "%s connectivity.",
                 gmic_selection.data(),tolerance,is_high_connectivity?"high":"low");
-          cimg_forY(selection,l) gmic_apply(label((bool)is_high_connectivity,tolerance));
+          cimg_forY(selection,l) gmic_apply(gmic_label((bool)is_high_connectivity,tolerance));
           is_released = false; continue;
         }
 
@@ -8418,6 +11337,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             print(images,0,"Move image%s to position %d.",
                   gmic_selection.data(),
                   iind0);
+            const bool is_indexed = images_names_index.begin();
             CImgList<T> _images, nimages;
             CImgList<char> _images_names, nimages_names;
             if (is_get) {
@@ -8438,9 +11358,22 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             images.insert(nimages.size(),iind0);
             cimglist_for(nimages,l) nimages[l].swap(images[iind0 + l]);
             nimages_names.move_to(images_names,iind0);
-            cimglist_for(images,l) if (!images[l] && images[l].is_shared()) {
-              images.remove(l); images_names.remove(l--); // Remove special items
+            unsigned int nind = 0; // Remove special items, in a single pass
+            cimglist_for(images,l) if (images[l] || !images[l].is_shared()) {
+              if (nind!=(unsigned int)l) {
+                images[nind].swap(images[l]);
+                images_names[nind].swap(images_names[l]);
+              }
+              ++nind;
+            }
+            if (nind<images._width) {
+              images.remove(nind,images._width - 1);
+              images_names.remove(nind,images_names._width - 1);
             }
+            if (selection) // Only images between the moved ones and the target position have changed
+              images_names_index.reordered(is_indexed,std::min(selection.min(),(unsigned int)iind0),
+                                           std::max(selection.max() + 1,(unsigned int)iind0) - 1);
+            else images_names_index.reordered(is_indexed,1,0);
             if (is_get) {
               cimglist_for(images,l) // Replace shared items by non-shared one for a get version
                 if (images[l].is_shared()) {
@@ -8449,6 +11382,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
               images.insert(_images.size(),0);
               cimglist_for(_images,l) images[l].swap(_images[l]);
               _images_names.move_to(images_names,0);
+              images_names_index.inserted(0,_images.size());
             }
           } else arg_error("move");
           is_released = false; ++position; continue;
@@ -8633,7 +11567,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
               print(images,0,"Apply median filter of size %g, on image%s.",
                     fsiz,
                     gmic_selection.data());
-            cimg_forY(selection,l) gmic_apply(blur_median((unsigned int)fsiz,threshold));
+            cimg_forY(selection,l) gmic_apply(gmic_blur_median((unsigned int)fsiz,threshold));
           } else arg_error("median");
           is_released = false; ++position; continue;
         }
@@ -8656,6 +11590,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
               remove_images(images,images_names,selection,1,selection.height() - 1);
               img.move_to(images[selection[0]].assign());
               name.move_to(images_names[selection[0]]);
+              images_names_index.renamed(selection[0],selection[0]);
             }
             g_list.assign();
           }
@@ -8795,8 +11730,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             if (g_list_c[l].back()) g_list_c[l].resize(g_list_c[l].width()+1,1,1,1,0);
             strreplace_fw(g_list_c[l]);
           }
-          cimg_forY(selection,l)
+          cimg_forY(selection,l) {
             images_names[selection[l]].assign(g_list_c[l%g_list_c.width()]);
+            images_names_index.renamed(selection[l],selection[l]);
+          }
           g_list_c.assign();
           ++position; continue;
         }
@@ -9207,7 +12144,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
         }
 
         // Output.
-        if (!is_get && !std::strcmp("output",command)) {
+        if (!std::strcmp("output",command)) {
           gmic_substitute_args(false);
 
           // Set good alias for shared variables.
@@ -9229,7 +12166,12 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           strreplace_fw(_filename);
           strreplace_fw(options);
           const bool is_stdout = *_filename=='-' && (!_filename[1] || _filename[1]=='.');
+#if cimg_OS==1
+          bool is_linked_output = false; // Is temporary filename a symbolic link to the final location?
+#endif // #if cimg_OS==1
 
+          if (*cext && !cimg::strcasecmp(cext,cimg::split_filename(_filename)))
+            *cext = 0; // Forced format matches filename extension: no need for a temporary filename
           if (*cext) { // Force output to be written as a '.ext' file : generate random filename
             if (is_stdout) {
               // Simplify filename 'ext:-.foo' as '-.ext'.
@@ -9243,6 +12185,23 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                               cimg::filenamerand(),cext);
                 if ((file=cimg::std_fopen(filename_tmp,"rb"))!=0) cimg::fclose(file);
               } while (file);
+
+#if cimg_OS==1
+              // Link temporary filename to the final location, so that data is written only once.
+              // Buffers are sized from the path lengths (no link if the current directory cannot be read).
+              CImg<char> target;
+              if (*_filename==cimg_file_separator) target = CImg<char>::string(_filename);
+              else {
+                CImg<char> cwd(256);
+                const char *s_cwd = 0;
+                while (!(s_cwd = getcwd(cwd,cwd.width())) && errno==ERANGE) cwd.assign(2*cwd.width());
+                if (s_cwd) {
+                  target.assign((unsigned int)(std::strlen(cwd) + std::strlen(_filename) + 2));
+                  cimg_snprintf(target,target.width(),"%s%c%s",cwd.data(),cimg_file_separator,_filename.data());
+                }
+              }
+              is_linked_output = target && !symlink(target,filename_tmp);
+#endif // #if cimg_OS==1
             }
           }
           const char
@@ -9251,6 +12210,30 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           CImg<char> uext = CImg<char>::string(ext);
           cimg::lowercase(uext);
 
+          // Encode images of 'g_list' as distinct numbered files, using several threads.
+          // Each iteration gets its own filename 'nfilename', errors are reported once all threads are done.
+#define gmic_save_numbered_begin \
+          { \
+            const int nb_threads = (int)std::min(gmic_nb_threads("GMIC_OUTPUT_THREADS"),g_list.size()); \
+            CImgList<char> errors(g_list.size()); \
+            cimg_pragma_openmp(parallel for num_threads(nb_threads) schedule(dynamic,1) if (nb_threads>1)) \
+            cimglist_for(g_list,l) { \
+              CImg<char> nfilename(_formula.width()); \
+              cimg::number_filename(filename,l,6,nfilename); \
+              try {
+
+#define gmic_save_numbered_end \
+              } catch (CImgException &e) { CImg<char>::string(e.what()).move_to(errors[l]); } \
+              catch (...) { CImg<char>::string("Unknown error").move_to(errors[l]); } \
+            } \
+            cimglist_for(errors,l) if (errors[l]) { \
+              cimg::number_filename(filename,l,6,formula); \
+              error(true,images,0,0, \
+                    "Command 'output': Unable to save file '%s' (%s).", \
+                    formula,errors[l].data()); \
+            } \
+          }
+
           if (!std::strcmp(uext,"off")) {
 
             // OFF file (geomview).
@@ -9266,10 +12249,9 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             print(images,0,"Output 3D object%s as %s file '%s'.",
                   gmic_selection.data(),uext.data(),formula);
 
-            cimg_forY(selection,l) {
-              const unsigned int uind = selection[l];
+            if (selection.height()==1) {
+              const unsigned int uind = selection[0];
               const CImg<T>& img = gmic_check(images[uind]);
-              if (selection.height()!=1) cimg::number_filename(filename,l,6,formula);
               CImgList<float> opacities;
               vertices.assign(img,false);
               try {
@@ -9283,10 +12265,30 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                         formula,uind,gmic_selection.data(),message.data());
                 else throw;
               }
+              vertices.assign();
+              primitives.assign();
+              g_list_f.assign();
+            } else {
+              g_list.assign(selection.height());
+              cimg_forY(selection,l) {
+                const unsigned int uind = selection[l];
+                const CImg<T>& img = gmic_check(images[uind]);
+                if (!img.is_CImg3d(true,&(*message=0))) {
+                  cimg::number_filename(filename,l,6,formula);
+                  error(true,images,0,0,
+                        "Command 'output': 3D object file '%s', invalid 3D object [%u] "
+                        "in selected image%s (%s).",
+                        formula,uind,gmic_selection.data(),message.data());
+                }
+                g_list[l].assign(img,true);
+              }
+              gmic_save_numbered_begin
+                CImgList<unsigned int> _primitives;
+                CImgList<float> _colors, _opacities;
+                CImg<float>(g_list[l],false).CImg3dtoobject3d(_primitives,_colors,_opacities,false).
+                  save_off(_primitives,_colors,nfilename);
+              gmic_save_numbered_end
             }
-            vertices.assign();
-            primitives.assign();
-            g_list_f.assign();
           } else if (!std::strcmp(uext,"cpp") || !std::strcmp(uext,"c") ||
                      !std::strcmp(uext,"hpp") || !std::strcmp(uext,"h") ||
                      !std::strcmp(uext,"pan")) {
@@ -9324,15 +12326,17 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                     "Command 'output': File '%s', instance list (%u,%p) is empty.",
                     _filename.data(),g_list.size(),g_list.data());
 
+            const bool is_pan = !std::strcmp(uext,"pan");
 #define gmic_save_multitype(value_type,svalue_type) \
               if (!std::strcmp(stype,svalue_type)) { \
-                if (g_list.size()==1) \
-                  CImg<value_type>::rounded_copy(g_list[0]).save(filename); \
-                else { \
-                  cimglist_for(g_list,l) { \
-                    cimg::number_filename(filename,l,6,formula); \
-                    CImg<value_type>::rounded_copy(g_list[l]).save(formula); \
-                  } \
+                if (g_list.size()==1) { \
+                  const CImg<value_type> &img = CImg<value_type>::rounded_copy(g_list[0]); \
+                  if (is_pan) img.save(filename); else img.save_gmic_cpp(filename); \
+                } else { \
+                  gmic_save_numbered_begin \
+                    const CImg<value_type> &img = CImg<value_type>::rounded_copy(g_list[l]); \
+                    if (is_pan) img.save(nfilename); else img.save_gmic_cpp(nfilename); \
+                  gmic_save_numbered_end \
                 } \
               }
             if (!std::strcmp(stype,"auto")) stype = CImg<T>::storage_type(g_list);
@@ -9412,11 +12416,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                   CImgList<value_type>::rounded_copy(g_list). \
                     save_tiff(filename,compression_type,0,0,use_bigtiff); \
                 else { \
-                  cimglist_for(g_list,l) { \
-                    cimg::number_filename(filename,l,6,formula); \
+                  gmic_save_numbered_begin \
                     CImg<value_type>::rounded_copy(g_list[l]). \
-                      save_tiff(formula,compression_type,0,0,use_bigtiff); \
-                  } \
+                      save_tiff(nfilename,compression_type,0,0,use_bigtiff); \
+                  gmic_save_numbered_end \
                 } \
               }
             if (!std::strcmp(stype,"auto")) stype = CImg<T>::storage_type(g_list);
@@ -9475,7 +12478,12 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                       g_list[0].depth(),g_list[0].spectrum());
               else print(images,0,"Output image%s as %s file '%s'.",
                          gmic_selection.data(),uext.data(),_filename.data());
-              g_list.save(filename); // Save distinct .gif files
+              if (g_list.size()==1 || is_stdout) g_list.save(filename);
+              else { // Save distinct .gif files
+                gmic_save_numbered_begin
+                  g_list[l].save(nfilename);
+                gmic_save_numbered_end
+              }
             }
           } else if (!std::strcmp(uext,"jpeg") || !std::strcmp(uext,"jpg")) {
 
@@ -9513,10 +12521,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             if (g_list.size()==1)
               g_list[0].save_jpeg(filename,(unsigned int)cimg::round(quality));
             else {
-              cimglist_for(g_list,l) {
-                cimg::number_filename(filename,l,6,formula);
-                g_list[l].save_jpeg(formula,(unsigned int)cimg::round(quality));
-              }
+              const unsigned int uquality = (unsigned int)cimg::round(quality);
+              gmic_save_numbered_begin
+                g_list[l].save_jpeg(nfilename,uquality);
+              gmic_save_numbered_end
             }
           } else if (!std::strcmp(uext,"mnc") && *options) {
 
@@ -9549,7 +12557,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                     options.data());
             if (g_list.size()==1)
               g_list[0].save_minc2(filename,options);
-            else {
+            else { // Sequential: the underlying HDF5 library is not thread-safe by default
               cimglist_for(g_list,l) {
                 cimg::number_filename(filename,l,6,formula);
                 g_list[l].save_minc2(formula,options);
@@ -9590,12 +12598,11 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
 #define gmic_save_raw(value_type,svalue_type) \
               if (!std::strcmp(stype,svalue_type)) { \
                 if (g_list.size()==1) \
-                  CImg<value_type>::rounded_copy(g_list[0]).save_raw(filename); \
+                  CImg<value_type>::save_rounded_raw(g_list[0],filename); \
                 else { \
-                  cimglist_for(g_list,l) { \
-                    cimg::number_filename(filename,l,6,formula); \
-                    CImg<value_type>::rounded_copy(g_list[l]).save_raw(formula); \
-                  } \
+                  gmic_save_numbered_begin \
+                    CImg<value_type>::save_rounded_raw(g_list[l],nfilename); \
+                  gmic_save_numbered_end \
                 } \
               }
             if (!std::strcmp(stype,"auto")) stype = CImg<T>::storage_type(g_list);
@@ -9639,18 +12646,32 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           } else if (!std::strcmp(uext,"cimg") || !std::strcmp(uext,"cimgz")) {
 
             // CImg[z] file.
-            const char *stype = cimg_sscanf(options,"%255[a-z64]%c",argx,&end)==1?argx:"auto";
+            unsigned int is_append = 0;
+            const char *stype = "auto";
+            if (cimg_sscanf(options,"%255[a-z64]%c",argx,&end)==1 ||
+                (cimg_sscanf(options,"%255[a-z64],%u%c",argx,&is_append,&end)==2 && is_append<=1)) stype = argx;
+            else is_append = 0;
+            if (is_append && !std::strcmp(stype,"auto")) {
+              const char *const file_stype = CImg<T>::gmic_cimg_file_pixel_type(filename);
+              if (file_stype) stype = file_stype;
+            }
             g_list.assign(selection.height());
             cimg_forY(selection,l)
               g_list[l].assign(images[selection[l]],images[selection[l]]?true:false);
-            print(images,0,"Output image%s as %s file '%s', with pixel type '%s'.",
+            print(images,0,"%s image%s %s %s file '%s', with pixel type '%s'.",
+                  is_append?"Append":"Output",
                   gmic_selection.data(),
+                  is_append?"to":"as",
                   uext.data(),_filename.data(),
                   stype);
 
 #define gmic_save_cimg(value_type,svalue_type) \
-              if (!std::strcmp(stype,svalue_type)) \
-                CImgList<value_type>::rounded_copy(g_list).save(filename);
+              if (!std::strcmp(stype,svalue_type)) { \
+                if (is_append) \
+                  CImg<value_type>::save_cimg_append(filename,CImgList<value_type>::rounded_copy(g_list),0, \
+                                                     !std::strcmp(uext,"cimgz")); \
+                else CImgList<value_type>::rounded_copy(g_list).save(filename); \
+              }
 
             if (!std::strcmp(stype,"auto")) stype = CImg<T>::storage_type(g_list);
             gmic_save_cimg(unsigned char,"uchar")
@@ -9674,21 +12695,34 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           } else if (!std::strcmp(uext,"gmz") || !*ext) {
 
             // GMZ file.
-            const char *stype = cimg_sscanf(options,"%255[a-z64]%c",argx,&end)==1?argx:"auto";
+            unsigned int is_append = 0;
+            const char *stype = "auto";
+            if (cimg_sscanf(options,"%255[a-z64]%c",argx,&end)==1 ||
+                (cimg_sscanf(options,"%255[a-z64],%u%c",argx,&is_append,&end)==2 && is_append<=1)) stype = argx;
+            else is_append = 0;
+            if (is_append && !std::strcmp(stype,"auto")) {
+              const char *const file_stype = CImg<T>::gmic_cimg_file_pixel_type(filename);
+              if (file_stype) stype = file_stype;
+            }
             g_list.assign(selection.height());
             g_list_c.assign(selection.height());
             cimg_forY(selection,l) {
               g_list[l].assign(images[selection[l]],images[selection[l]]?true:false);
               g_list_c[l].assign(images_names[selection[l]],true);
             }
-            print(images,0,"Output image%s as %s file '%s', with pixel type '%s'.",
+            print(images,0,"%s image%s %s %s file '%s', with pixel type '%s'.",
+                  is_append?"Append":"Output",
                   gmic_selection.data(),
+                  is_append?"to":"as",
                   uext.data(),_filename.data(),
                   stype);
 
 #define gmic_save_gmz(value_type,svalue_type) \
-              if (!std::strcmp(stype,svalue_type)) \
-                CImg<value_type>::save_gmz(filename,CImgList<value_type>::rounded_copy(g_list),g_list_c);
+              if (!std::strcmp(stype,svalue_type)) { \
+                if (is_append) \
+                  CImg<value_type>::save_cimg_append(filename,CImgList<value_type>::rounded_copy(g_list),&g_list_c,true); \
+                else CImg<value_type>::save_gmz(filename,CImgList<value_type>::rounded_copy(g_list),g_list_c); \
+              }
 
             if (!std::strcmp(stype,"auto")) stype = CImg<T>::storage_type(g_list);
             gmic_save_gmz(unsigned char,"uchar")
@@ -9775,25 +12809,48 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             }
             cimg_forY(selection,l)
               g_list[l].assign(images[selection[l]],g_list[l]?true:false);
+            const bool is_async = is_get && !*cext && !is_stdout;
             if (g_list.size()==1)
-              print(images,0,"Output image%s as %s file '%s' (1 image %dx%dx%dx%d).",
+              print(images,0,"Output image%s as %s file '%s'%s (1 image %dx%dx%dx%d).",
                     gmic_selection.data(),
-                    uext.data(),_filename.data(),
+                    uext.data(),_filename.data(),is_async?" asynchronously":"",
                     g_list[0].width(),g_list[0].height(),
                     g_list[0].depth(),g_list[0].spectrum());
-            else print(images,0,"Output image%s as %s file '%s'.",
-                       gmic_selection.data(),uext.data(),_filename.data());
+            else print(images,0,"Output image%s as %s file '%s'%s.",
+                       gmic_selection.data(),uext.data(),_filename.data(),is_async?" asynchronously":"");
 
             if (*options)
               error(true,images,0,0,
                     "Command 'output': File '%s', format '%s' does not take any output options "
                     "(options '%s' specified).",
                     _filename.data(),ext,options.data());
-            if (g_list.size()==1) g_list[0].save(filename); else g_list.save(filename);
+            const bool is_dlm = !std::strcmp(uext,"csv") || !std::strcmp(uext,"dlm") || !std::strcmp(uext,"txt");
+            if (is_async) { // Save a copy of the images from the output worker threads
+              CImgList<T> a_list(g_list,false);
+              output_pool.push(a_list,filename,is_dlm);
+            } else if (g_list.size()==1) {
+              if (is_dlm) g_list[0].save_gmic_dlm(filename); else g_list[0].save(filename);
+            } else if (is_stdout || !std::strcmp(uext,"gz")) g_list.save(filename);
+            else {
+              gmic_save_numbered_begin
+                if (is_dlm) g_list[l].save_gmic_dlm(nfilename); else g_list[l].save(nfilename);
+              gmic_save_numbered_end
+            }
           }
 
           if (*cext) { // When output forced to 'ext' : copy final file to specified location
-            try {
+            bool is_copy_needed = true;
+#if cimg_OS==1
+            struct stat st_tmp;
+            if (is_linked_output && !lstat(filename_tmp,&st_tmp) && S_ISLNK(st_tmp.st_mode)) {
+              // Data has been written through the symbolic link, unless several numbered files were saved.
+              std::remove(filename_tmp);
+              cimg::number_filename(filename_tmp,0,6,formula);
+              std::FILE *const file = cimg::std_fopen(formula,"rb");
+              if (file) cimg::fclose(file); else is_copy_needed = false;
+            }
+#endif // #if cimg_OS==1
+            if (is_copy_needed) try {
               CImg<unsigned char>::get_load_raw(filename_tmp).save_raw(_filename);
               std::remove(filename_tmp);
             } catch (...) { // Failed, maybe 'filename_tmp' consists of several numbered images
@@ -9961,28 +13018,8 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           }
 
           // Run threads.
-          cimg_forY(_gmic_threads,l) {
-#ifdef gmic_is_parallel
-#ifdef _PTHREAD_H
-
-#if defined(__MACOSX__) || defined(__APPLE__)
-            const uint64T stacksize = (uint64T)8*1024*1024;
-            pthread_attr_t thread_attr;
-            if (!pthread_attr_init(&thread_attr) && !pthread_attr_setstacksize(&thread_attr,stacksize))
-              // Reserve enough stack size for the new thread.
-              pthread_create(&_gmic_threads[l].thread_id,&thread_attr,gmic_parallel<T>,(void*)&_gmic_threads[l]);
-            else
-#endif // #if defined(__MACOSX__) || defined(__APPLE__)
-              pthread_create(&_gmic_threads[l].thread_id,0,gmic_parallel<T>,(void*)&_gmic_threads[l]);
-
-#elif cimg_OS==2 // #ifdef _PTHREAD_H
-            _gmic_threads[l].thread_id = CreateThread(0,0,gmic_parallel<T>,
-                                                      (void*)&_gmic_threads[l],0,0);
-#endif // #ifdef _PTHREAD_H
-#else // #ifdef gmic_is_parallel
-            gmic_parallel<T>((void*)&_gmic_threads[l]);
-#endif // #ifdef gmic_is_parallel
-          }
+          images_names_index.is_valid = false; // Threads may rename images of the list
+          cimg_forY(_gmic_threads,l) gmic_launch_thread(_gmic_threads[l]);
 
           // Wait threads if immediate waiting mode selected.
           if (wait_mode) {
@@ -10300,8 +13337,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           if (is_get) { g_list.assign(images); g_list_c.assign(images_names); }
           remove_images(images,images_names,selection,0,selection.height() - 1);
           if (is_get) {
+            const unsigned int nb = g_list_c.size();
             g_list.move_to(images,0);
             g_list_c.move_to(images_names,0);
+            images_names_index.inserted(0,nb);
           }
           if (is_verbose) {
             cimg::mutex(29);
@@ -10533,10 +13572,13 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
               const unsigned int i = selection[selection.height() - 1 - l];
               images.insert(images[i]);
               images_names.insert(images_names[i]);
+              images_names_index.inserted(images_names._width - 1,1);
             } else for (unsigned int l = 0; l<selection._height/2; ++l) {
               const unsigned int i0 = selection[l], i1 = selection[selection.height() - 1 - l];
               images[i0].swap(images[i1]);
               images_names[i0].swap(images_names[i1]);
+              images_names_index.renamed(i0,i0);
+              images_names_index.renamed(i1,i1);
             }
           is_released = false; continue;
         }
@@ -11685,6 +14727,26 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           is_released = false; continue;
         }
 
+        // Wait for threads running in background (asynchronous outputs and non-waiting 'parallel').
+        if (!is_get && !std::strcmp("sync",item)) {
+          unsigned int nb_threads = 0;
+          cimglist_for(gmic_threads,k) nb_threads+=gmic_threads[k].height();
+          print(images,0,"Wait for termination of %u background thread%s and pending asynchronous outputs.",
+                nb_threads,nb_threads==1?"":"s");
+          cimglist_for(gmic_threads,k) wait_threads(&gmic_threads[k],false,(T)0);
+          CImgList<_gmic_parallel<T> > terminated_threads;
+          gmic_threads.move_to(terminated_threads);
+          const CImg<char> output_errors = output_pool.sync();
+
+          // Check for possible exceptions thrown by threads.
+          cimglist_for(terminated_threads,k) cimg_forY(terminated_threads[k],l)
+            if (terminated_threads(k,l).exception._message)
+              error(false,images,0,terminated_threads(k,l).exception.command_help(),
+                    "%s",terminated_threads(k,l).exception.what());
+          if (output_errors) error(true,images,0,0,"%s",output_errors.data());
+          continue;
+        }
+
         // Input 3D sphere.
         if (!is_get && !std::strcmp("sphere3d",item)) {
           gmic_substitute_args(false);
@@ -11928,7 +14990,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
 #define gmic_serialize(value_type,svalue_type) \
           if (!std::strcmp(argx,svalue_type)) \
             CImgList<value_type>(g_list,cimg::type<T>::string()==cimg::type<value_type>::string()). \
-              get_serialize((bool)is_compressed).move_to(serialized);
+              get_gmic_serialize((bool)is_compressed).move_to(serialized);
 
           gmic_substitute_args(false);
 #ifdef cimg_use_zlib
@@ -12181,7 +15243,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           cimg_forY(selection,l) {
             const unsigned int uind = selection[l] + off;
             const CImg<T>& img = gmic_check(images[uind]);
-            g_list = CImgList<T>::get_unserialize(img);
+            g_list = CImgList<T>::get_gmic_unserialize(img);
             if (g_list) {
               const CImg<T>& back = g_list.back();
               if (back.width()==1 && back.depth()==1 && back.spectrum()==1 &&
@@ -12843,6 +15905,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                 g_list[1].swap(img1);
                 name.get_copymark().move_to(images_names[uind1]);
                 name.move_to(images_names[uind0]);
+                images_names_index.renamed(uind1,uind1);
               }
               ++l;
             } else { // Real transform
@@ -12853,7 +15916,34 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                 std::fflush(cimg::output());
                 cimg::mutex(29,0);
               }
-              if (is_get) {
+              bool is_real_fft = false;
+#ifdef cimg_use_fftw3
+              // Transform along all axes: use a cached real-to-complex FFTW plan.
+              bool is_all_axes = true;
+              if (is_valid_argument) {
+                const bool
+                  is_x = std::strchr(argument,'x')!=0,
+                  is_y = std::strchr(argument,'y')!=0,
+                  is_z = std::strchr(argument,'z')!=0;
+                is_all_axes = std::strlen(argument)==(unsigned int)(is_x + is_y + is_z) &&
+                  (is_x || img0._width==1) && (is_y || img0._height==1) && (is_z || img0._depth==1);
+              }
+              if (is_all_axes) {
+                g_list.assign(2);
+                is_real_fft = CImg<T>::gmic_fft_real(img0,g_list[0],g_list[1],inv_fft);
+              }
+#endif // #ifdef cimg_use_fftw3
+              if (is_real_fft) {
+                if (is_get) {
+                  g_list.move_to(images,~0U);
+                  images_names.insert(2,name.copymark());
+                } else {
+                  g_list[0].swap(img0);
+                  g_list[1].move_to(images,uind0 + 1);
+                  name.get_copymark().move_to(images_names,uind0 + 1);
+                  name.move_to(images_names[uind0]);
+                }
+              } else if (is_get) {
                 g_list.assign(img0);
                 CImg<T>(g_list[0].width(),g_list[0].height(),g_list[0].depth(),g_list[0].spectrum(),(T)0).
                   move_to(g_list);
@@ -13248,9 +16338,11 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                 cimg::swap(exception._command_help,e._command_help);
                 cimg::swap(exception._message,e._message);
               }
+              const unsigned int nb = g_list_c.size();
               g_list.move_to(images,~0U);
               cimglist_for(g_list_c,l) g_list_c[l].copymark();
               g_list_c.move_to(images_names,~0U);
+              images_names_index.inserted(images_names._width - nb,nb);
             } else {
               cimg::mutex(27);
               cimg_forY(selection,l) {
@@ -13292,6 +16384,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                     g_list[i].assign();
                   } else images[uind].swap(g_list[i]);
                   images_names[uind].swap(g_list_c[i]);
+                  images_names_index.renamed(uind,uind);
                 }
                 g_list.remove(0,nb - 1);
                 g_list_c.remove(0,nb - 1);
@@ -13299,9 +16392,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
               if (nb<(unsigned int)selection.height())
                 remove_images(images,images_names,selection,nb,selection.height() - 1);
               else if (g_list) {
-                const unsigned int uind0 = selection?selection.back() + 1:images.size();
+                const unsigned int uind0 = selection?selection.back() + 1:images.size(), nb = g_list_c.size();
                 g_list_c.move_to(images_names,uind0);
                 g_list.move_to(images,uind0);
+                images_names_index.inserted(uind0,nb);
               }
             }
             for (unsigned int l = 0; l<nvariables_sizes._width - 2; ++l) if (variables[l]->size()>nvariables_sizes[l]) {
@@ -13570,10 +16664,11 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                 _gmic_selection.data());
         CImg<T> new_image(idx,idy,idz,idc);
         if (s_values) {
+          if (CImg<T>::gmic_memory_policy()>1) new_image.gmic_first_touch((T)0); // Place pages before filling
           new_image.fill(s_values.data(),true,true,&images,&images);
           cimg_snprintf(title,_title.width(),"[image of '%s']",s_values.data());
           CImg<char>::string(title).move_to(input_images_names);
-        } else { new_image.fill((T)0); CImg<char>::string("[unnamed]").move_to(input_images_names); }
+        } else { new_image.gmic_first_touch((T)0); CImg<char>::string("[unnamed]").move_to(input_images_names); }
         new_image.move_to(input_images);
 
       } else if (*arg_input=='(' && arg_input[std::strlen(arg_input) - 1]==')') {
@@ -13665,6 +16760,8 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           *filename_tmp = 0;
         }
 
+        if (*cext && !cimg::strcasecmp(cext,cimg::split_filename(_filename)))
+          *cext = 0; // Forced format matches filename extension: read file directly
         if (*cext) { // Force input to be read as a '.ext' file : generate random filename
           if (*_filename=='-' && (!_filename[1] || _filename[1]=='.')) {
             // Simplify filename 'ext:-.foo' as '-.ext'.
@@ -13709,6 +16806,48 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
         if (!is_stdin && file && _siz==0) { // Empty file -> Insert an empty image
           input_images_names.insert(__filename0);
           input_images.insert(1);
+        } else if (!file && !is_stdin && !*cext && !*options && !is_network_file &&
+                   (std::strchr(_filename,'*') || std::strchr(_filename,'?')) &&
+                   (cimg::files(_filename,true,0,true).move_to(g_list_c),g_list_c)) {
+
+          // Files matching a glob pattern.
+          // Files are decoded in parallel, each with the same format dispatch as a single input file.
+          const unsigned int
+            nb_files = g_list_c.size(),
+            nb_threads = std::min(gmic_nb_threads("GMIC_INPUT_THREADS"),nb_files);
+          CImgList<T> *const decoded = new CImgList<T>[nb_files];
+          CImgList<char> *const decoded_names = new CImgList<char>[nb_files];
+          CImgList<char> errors(nb_files);
+          const cimg_ulong time0 = cimg::time();
+          cimg_pragma_openmp(parallel for num_threads((int)nb_threads) schedule(dynamic,1) if (nb_threads>1))
+          for (int l = 0; l<(int)nb_files; ++l) {
+            try { decoded[l].load_gmic_file(g_list_c[l],decoded_names[l],g_list_c[l]); }
+            catch (CImgException &e) { CImg<char>::string(e.what()).move_to(errors[l]); }
+            catch (...) { CImg<char>::string("Unknown error").move_to(errors[l]); }
+          }
+          const double elapsed = std::max((double)(cimg::time() - time0),1.)/1000;
+          int ind_error = -1;
+          cimglist_for(errors,l) if (errors[l]) { ind_error = l; break; }
+          if (ind_error>=0) {
+            delete[] decoded; delete[] decoded_names;
+            error(true,images,0,0,
+                  "Command 'input': Unable to load file '%s' matching pattern '%s' (%s).",
+                  g_list_c[ind_error].data(),_filename0,errors[ind_error].data());
+          }
+          cimg_ulong nb_pixels = 0;
+          for (unsigned int l = 0; l<nb_files; ++l) {
+            cimglist_for(decoded[l],k) nb_pixels+=decoded[l][k].size();
+            decoded[l].move_to(input_images,~0U);
+            decoded_names[l].move_to(input_images_names,~0U);
+          }
+          delete[] decoded; delete[] decoded_names;
+          print(images,0,"Input %u files matching pattern '%s' (%g files/s, %g Mpixels/s, "
+                "with %u decoding thread%s) at position%s",
+                nb_files,_filename0,nb_files/elapsed,nb_pixels/(1e6*elapsed),
+                nb_threads,nb_threads>1?"s":"",
+                _gmic_selection.data());
+          g_list_c.assign();
+
         } else if (!cimg::strcasecmp("off",ext) || (file_type && !std::strcmp(file_type,"off"))) {
 
           // 3D object .off file.
@@ -13815,26 +16954,38 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
                   "Command 'input': .cimg file '%s', invalid file options '%s'.",
                   _filename0,options.data());
 
+        } else if ((!cimg::strcasecmp(ext,"gmz") || !cimg::strcasecmp(ext,"cimgz")) && *options) {
+
+          // Range of images from a .gmz or .cimgz file (only selected images are decompressed).
+          const bool is_gmz = !cimg::strcasecmp(ext,"gmz");
+          float n0 = -1, n1 = -1;
+          if (cimg_sscanf(options,"%f,%f%c",&n0,&n1,&end)==2 && n0>=0 && n1>=0) {
+            n0 = cimg::round(n0); n1 = cimg::round(n1);
+            print(images,0,"Input images [%d] -> [%d] of file '%s' at position%s",
+                  (int)n0,(int)n1,
+                  _filename0,_gmic_selection.data());
+            input_images.load_cimg_frames(filename,(unsigned int)n0,(unsigned int)n1,
+                                          is_gmz?&input_images_names:0);
+            if (is_gmz && input_images.size()!=input_images_names.size())
+              error(true,images,0,0,"Command 'input': File '%s' is not in .gmz format "
+                    "(numbers of images and names do not match).",
+                    _filename0);
+            if (!is_gmz && input_images) {
+              input_images_names.insert(__filename0);
+              if (input_images.size()>1)
+                input_images_names.insert(input_images.size() - 1,__filename0.copymark());
+            }
+          } else
+            error(true,images,0,0,
+                  "Command 'input': .%s file '%s', invalid file options '%s'.",
+                  ext,_filename0,options.data());
+
         } else if (!cimg::strcasecmp(ext,"gmz")) {
           print(images,0,"Input file '%s' at position%s",
                 _filename0,
                 _gmic_selection.data());
-          input_images.load_cimg(filename);
-          bool is_gmz = false;
-          const CImg<char> back = input_images?CImg<char>(input_images.back()):CImg<char>::empty();
-          if (back.width()==1 && back.depth()==1 && back.spectrum()==1 &&
-              back[0]=='G' && back[1]=='M' && back[2]=='Z' && !back[3]) {
-            input_images_names = back.get_split(CImg<char>::vector(0),0,false);
-            if (input_images_names) {
-              is_gmz = true;
-              input_images_names.remove(0);
-              cimglist_for(input_images_names,l)
-                input_images_names[l].resize(1,input_images_names[l].height() + 1,1,1,0).
-                unroll('x');
-              input_images.remove();
-            }
-          }
-          if (!is_gmz)
+          input_images.load_cimg_frames(filename,0,~0U);
+          if (!input_images._gmic_gmz_names(input_images_names))
             error(true,images,0,0,"Command 'input': File '%s' is not in .gmz format (magic number not found).",
                   _filename0);
           if (input_images.size()!=input_images_names.size())
@@ -13846,35 +16997,15 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           print(images,0,"Input file '%s' at position%s",
                 _filename0,
                 _gmic_selection.data());
-          input_images.load_cimg(filename);
+          if (!cimg::strcasecmp(ext,"cimgz")) input_images.load_cimg_frames(filename,0,~0U);
+          else input_images.load_cimg(filename);
           if (input_images) {
             input_images_names.insert(__filename0);
             if (input_images.size()>1)
               input_images_names.insert(input_images.size() - 1,__filename0.copymark());
           }
 
-        } else if (!cimg::strcasecmp(ext,"avi") ||
-                   !cimg::strcasecmp(ext,"mov") ||
-                   !cimg::strcasecmp(ext,"asf") ||
-                   !cimg::strcasecmp(ext,"divx") ||
-                   !cimg::strcasecmp(ext,"flv") ||
-                   !cimg::strcasecmp(ext,"mpg") ||
-                   !cimg::strcasecmp(ext,"m1v") ||
-                   !cimg::strcasecmp(ext,"m2v") ||
-                   !cimg::strcasecmp(ext,"m4v") ||
-                   !cimg::strcasecmp(ext,"mjp") ||
-                   !cimg::strcasecmp(ext,"mp4") ||
-                   !cimg::strcasecmp(ext,"mkv") ||
-                   !cimg::strcasecmp(ext,"mpe") ||
-                   !cimg::strcasecmp(ext,"movie") ||
-                   !cimg::strcasecmp(ext,"ogm") ||
-                   !cimg::strcasecmp(ext,"ogg") ||
-                   !cimg::strcasecmp(ext,"qt") ||
-                   !cimg::strcasecmp(ext,"rm") ||
-                   !cimg::strcasecmp(ext,"vob") ||
-                   !cimg::strcasecmp(ext,"wmv") ||
-                   !cimg::strcasecmp(ext,"xvid") ||
-                   !cimg::strcasecmp(ext,"mpeg")) {
+        } else if (CImgList<T>::_gmic_is_video_ext(ext)) {
 
           // Image sequence file.
           float first_frame = 0, last_frame = -1, step = 1;
@@ -13902,11 +17033,37 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           } else if (cimg_sscanf(options,"%f%c",&first_frame,&end)==1 &&
                      first_frame>=0) {
             // Read a single frame.
+            // When frames of a same file are requested in increasing order, they are read from a video stream
+            // decoded in background.
             const unsigned int _first_frame = (unsigned int)first_frame;
             print(images,0,"Input frame %u of file '%s' at position%s",
                   _first_frame,_filename0,
                   _gmic_selection.data());
-            input_images.load_video(filename,_first_frame,_first_frame);
+            if (!video_stream) video_stream = new _gmic_video_stream;
+            _gmic_video_stream &vs = *(_gmic_video_stream*)video_stream;
+            CImg<T> frame;
+            bool is_streamed = false;
+            const bool is_successor = vs.requested_filename &&
+              !std::strcmp(vs.requested_filename,filename) &&
+              vs.requested_frame!=~0U && _first_frame>vs.requested_frame;
+            if (vs.is_reachable(filename,_first_frame))
+              is_streamed = vs.get(_first_frame,frame);
+            else if (is_successor && !vs.is_failed) {
+              const char *const s_slots = std::getenv("GMIC_VIDEO_PREFETCH");
+              const int nb_slots = s_slots?std::atoi(s_slots):8;
+              if (nb_slots>0 &&
+                  vs.start(filename,_first_frame,_first_frame - vs.requested_frame,(unsigned int)nb_slots)) {
+                is_streamed = vs.get(_first_frame,frame);
+                if (!is_streamed) { vs.stop(); vs.is_failed = true; }
+              }
+            }
+            if (!is_successor) vs.is_failed = false;
+            vs.lock();
+            CImg<char>::string(filename).move_to(vs.requested_filename);
+            vs.requested_frame = _first_frame;
+            vs.unlock();
+            if (is_streamed) frame.move_to(input_images);
+            else input_images.load_video(filename,_first_frame,_first_frame);
           } else if (!*options) {
             // Read all frames.
             print(images,0,"Input all frames of file '%s' at position%s",
@@ -13963,10 +17120,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
 
 #define gmic_load_raw(value_type,svalue_type) \
             if (!cimg::strcasecmp(stype,svalue_type)) \
-              CImg<value_type>::get_load_raw(filename, \
-                                             (unsigned int)dx,(unsigned int)dy, \
-                                             (unsigned int)dz,(unsigned int)dc,false,false,\
-                                             (cimg_ulong)offset).move_to(input_images);
+              CImg<T>::template get_load_raw_mapped<value_type>(filename, \
+                                                                (unsigned int)dx,(unsigned int)dy, \
+                                                                (unsigned int)dz,(unsigned int)dc, \
+                                                                (cimg_ulong)offset).move_to(input_images);
             gmic_load_raw(unsigned char,"uchar")
             else gmic_load_raw(unsigned char,"unsigned char")
               else gmic_load_raw(char,"char")
@@ -14055,7 +17212,20 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           if (is_very_verbose) TIFFSetWarningHandler(default_handler);
           else TIFFSetWarningHandler(0);
 #endif // #ifdef cimg_use_tiff
-          if ((err = cimg_sscanf(options,"%f,%f,%f",&first_frame,&last_frame,&step))>0) {
+          float x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+          if (cimg_sscanf(options,"%f,%f,%f,%f,%f,%f%c",
+                          &first_frame,&last_frame,&x0,&y0,&x1,&y1,&end)==6 &&
+              first_frame>=0 && last_frame>=0 && x0>=0 && y0>=0 && x1>=0 && y1>=0) { // Load region of interest
+            first_frame = cimg::round(first_frame); last_frame = cimg::round(last_frame);
+            x0 = cimg::round(x0); y0 = cimg::round(y0);
+            x1 = cimg::round(x1); y1 = cimg::round(y1);
+            print(images,0,"Input crop [%g](%g,%g) -> [%g](%g,%g) of TIFF file '%s' at position%s",
+                  first_frame,x0,y0,last_frame,x1,y1,
+                  _filename0,
+                  _gmic_selection.data());
+            input_images.load_tiff_roi(filename,(unsigned int)first_frame,(unsigned int)last_frame,
+                                       (unsigned int)x0,(unsigned int)y0,(unsigned int)x1,(unsigned int)y1);
+          } else if ((err = cimg_sscanf(options,"%f,%f,%f",&first_frame,&last_frame,&step))>0) {
             first_frame = cimg::round(first_frame);
             if (err>1) { // Load multiple frames
               last_frame = cimg::round(last_frame);
@@ -14151,7 +17321,12 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
 
           try {
             try {
-              input_images.load(filename);
+              if (!is_stdin && (!cimg::strcasecmp(ext,"csv") || !cimg::strcasecmp(ext,"dlm") ||
+                                !cimg::strcasecmp(ext,"txt"))) {
+                // Numeric text file: try fast parser first.
+                try { CImg<T>().load_gmic_dlm(filename).move_to(input_images); }
+                catch (CImgException&) { input_images.assign(); input_images.load(filename); }
+              } else input_images.load(filename);
             } catch (CImgIOException&) {
               if (is_network_file)
                 error(true,images,0,0,
@@ -14161,20 +17336,7 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
             }
 
             // If .gmz file without extension, process images names anyway.
-            bool is_gmz = false;
-            const CImg<char> back = input_images?CImg<char>(input_images.back()):CImg<char>::empty();
-            if (back.width()==1 && back.depth()==1 && back.spectrum()==1 &&
-                back[0]=='G' && back[1]=='M' && back[2]=='Z' && !back[3]) {
-              input_images_names = back.get_split(CImg<char>::vector(0),0,false);
-              if (input_images_names) {
-                is_gmz = true;
-                input_images_names.remove(0);
-                cimglist_for(input_images_names,l)
-                  input_images_names[l].resize(1,input_images_names[l].height() + 1,1,1,0).
-                  unroll('x');
-                input_images.remove(input_images.size() - 1);
-              }
-            }
+            const bool is_gmz = input_images._gmic_gmz_names(input_images_names);
 
             if (input_images && !is_gmz) {
               input_images_names.insert(__filename0);
@@ -14253,8 +17415,10 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
         cimg::mutex(29,0);
       }
 
+      if (CImg<T>::gmic_memory_policy()) cimglist_for(input_images,l) input_images[l].gmic_advise_hugepages();
+
       for (unsigned int l = 0, lsiz = selection.height() - 1U, off = 0; l<=lsiz; ++l) {
-        const unsigned int uind = selection[l] + off;
+        const unsigned int uind = selection[l] + off, nb = input_images_names.size();
         off+=input_images.size();
         if (l!=lsiz) {
           images.insert(input_images,uind);
@@ -14263,9 +17427,13 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
           input_images.move_to(images,uind);
           input_images_names.move_to(images_names,uind);
         }
+        images_names_index.inserted(uind,nb);
       }
 
-      if (new_name) new_name.move_to(images_names[selection[0]]);
+      if (new_name) {
+        new_name.move_to(images_names[selection[0]]);
+        images_names_index.renamed(selection[0],selection[0]);
+      }
       is_released = false;
     } // End main parsing loop of _run()
 
@@ -14273,6 +17441,8 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
     cimglist_for(gmic_threads,k) wait_threads(&gmic_threads[k],true,(T)0);
     cimglist_for(gmic_threads,k) cimg_forY(gmic_threads[k],l)
       if (gmic_threads(k,l).exception._message) throw gmic_threads(k,l).exception;
+    const CImg<char> output_errors = output_pool.sync();
+    if (output_errors) error(true,images,0,0,"%s",output_errors.data());
 
     // Post-check global environment consistency.
     if (images_names.size()!=images.size())
@@ -14349,14 +17519,20 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
         is_quit = true;
       }
     }
-  } catch (gmic_exception&) {
-    // Wait for remaining threads to finish.
+  } catch (gmic_exception &e) {
+    // Wait for remaining threads and asynchronous outputs to finish (and report output errors with exception).
     cimglist_for(gmic_threads,k) wait_threads(&gmic_threads[k],true,(T)0);
+    const CImg<char> output_errors = output_pool.sync();
+    if (output_errors)
+      (CImgList<char>(CImg<char>(e._message.data(),e._message?(unsigned int)std::strlen(e._message):0U),
+                      CImg<char>::vector('\n'),output_errors)>'x').move_to(e._message);
     throw;
 
   } catch (CImgAbortException &) { // Special case of abort (abort from a CImg method)
-    // Wait for remaining threads to finish.
+    // Wait for remaining threads and asynchronous outputs to finish.
     cimglist_for(gmic_threads,k) wait_threads(&gmic_threads[k],true,(T)0);
+    const CImg<char> output_errors = output_pool.sync();
+    if (output_errors) warn(images,0,false,"%s",output_errors.data());
 
     // Do the same as for a cancellation point.
     const bool is_very_verbose = verbosity>0 || is_debug;
@@ -14368,8 +17544,9 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
     is_released = is_quit = true;
 
   } catch (CImgException &e) {
-    // Wait for remaining threads to finish.
+    // Wait for remaining threads and asynchronous outputs to finish (and report output errors with exception).
     cimglist_for(gmic_threads,k) wait_threads(&gmic_threads[k],true,(T)0);
+    const CImg<char> output_errors = output_pool.sync();
 
     const char *const e_ptr = e.what() + (!std::strncmp(e.what(),"[gmic_math_parser] ",19)?19:0);
     CImg<char> error_message(e_ptr,(unsigned int)std::strlen(e_ptr) + 1);
@@ -14379,8 +17556,12 @@ gmic& gmic::_run(const CImgList<char>& commands_line, unsigned int& position,
     if (!std::strncmp(error_message,s_fopen,l_fopen) &&
         !std::strcmp(error_message.end() - 18,"' with mode 'rb'.")) {
       error_message[error_message.width() - 18] = 0;
-      error(true,images,0,0,"Unknown filename '%s'.",error_message.data(l_fopen));
+      error(true,images,0,0,"Unknown filename '%s'.%s%s",error_message.data(l_fopen),
+            output_errors?"\n":"",output_errors?output_errors.data():"");
     }
+    if (output_errors)
+      (CImgList<char>(CImg<char>(error_message.data(),(unsigned int)std::strlen(error_message)),
+                      CImg<char>::vector('\n'),output_errors)>'x').move_to(error_message);
     for (char *str = std::strstr(error_message,"CImg<"); str; str = std::strstr(str,"CImg<")) {
       str[0] = 'g'; str[1] = 'm'; str[2] = 'i'; str[3] = 'c';
     }
@@ -163,6 +163,10 @@ namespace cimg_library {
 #endif // #ifdef _MSC_VER
 
 #include <locale>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h> // For 'mmap()' and 'madvise()', used by raw file input and large buffers
+#endif // #if defined(__linux__)
 #ifdef cimg_version
 #error "[gmic] *** Error *** File 'CImg.h' has been already included (should have been done first in file 'gmic.h')."
 #endif
@@ -390,6 +394,7 @@ struct gmic {
   gmic_image<unsigned int> dowhiles, fordones, repeatdones;
   gmic_image<unsigned char> light3d;
   gmic_image<void*> display_windows;
+  void *video_stream, *names_index;
   gmic_image<char> status;
 
   float focale3d, light3d_x, light3d_y, light3d_z, specular_lightness3d, specular_shininess3d, _progress, *progress;